@@ -0,0 +1,225 @@
+#include <opencv2/opencv.hpp>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// benchmark harness
+#include "src/cpp/bench/hpp/benchmark.hpp"
+#include "src/cpp/bindings/hpp/number_parser.hpp"
+#include "src/cpp/runtime/hpp/scheduler.hpp"
+
+// command line options of the benchmark
+struct BenchOptions {
+    BenchSettings settings;
+    bool run_operations = true;
+    std::string output_file;
+    std::string baseline_file;
+    double tolerance = 0.10;
+    size_t threads = 0;
+    bool show_help = false;
+};
+
+// print command line usage
+static void printUsage(const char* program) {
+    std::cout << "usage: " << program << " [options]" << std::endl;
+    std::cout << "options:" << std::endl;
+    std::cout << "  -h, --help          print this help" << std::endl;
+    std::cout << "  --sizes <list>      vga,hd,fhd,4k,12mp,50mp or <w>x<h>; 'all' for vga to 50mp (default vga,fhd,4k)" << std::endl;
+    std::cout << "  --channels <list>   channel counts to test (default 3)" << std::endl;
+    std::cout << "  --rois <list>       full, half and/or tile (default full)" << std::endl;
+    std::cout << "  --ops <list>        operations to time (default all)" << std::endl;
+    std::cout << "  --no-ops            only time pipelines" << std::endl;
+    std::cout << "  --pipeline <file>   time a json pipeline end to end (repeatable)" << std::endl;
+    std::cout << "  --tile <size>       tile size used for pipelines (default untiled)" << std::endl;
+    std::cout << "  --warmup <n>        untimed runs per case (default 2)" << std::endl;
+    std::cout << "  --reps <n>          timed runs per case (default 10)" << std::endl;
+    std::cout << "  --threads <n>       thread budget for opencv inside one image (default all cores)" << std::endl;
+    std::cout << "  --output <file>     write results as json" << std::endl;
+    std::cout << "  --baseline <file>   compare medians against stored results, exit 1 on a regression" << std::endl;
+    std::cout << "  --tolerance <f>     allowed median slowdown before it counts as a regression (default 0.10)" << std::endl;
+    std::cout << "example: " << program << " --sizes all --channels 1,3 --pipeline tests/json/test_pipeline.json --output bench.json" << std::endl;
+}
+
+// split a comma separated list
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// parse flags, false on a malformed one
+static bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+    auto& settings = options.settings;
+    settings.sizes = Benchmark::defaultSizes(false);
+
+    // options followed by a value
+    static const std::set<std::string> valued = {"--sizes", "--channels", "--rois", "--ops", "--pipeline", "--tile",
+                                                 "--warmup", "--reps", "--threads", "--output", "--baseline", "--tolerance"};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            options.show_help = true;
+            return true;
+        }
+        if (arg == "--no-ops") {
+            options.run_operations = false;
+            continue;
+        }
+        if (valued.count(arg) == 0) {
+            std::cerr << "error: unknown option '" << arg << "'" << std::endl;
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "error: option '" << arg << "' needs a value" << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--sizes") {
+            settings.sizes.clear();
+            if (value == "all") {
+                settings.sizes = Benchmark::defaultSizes(true);
+                continue;
+            }
+            for (const auto& label : splitList(value)) {
+                BenchSize size;
+                if (!Benchmark::parseSize(label, size)) {
+                    std::cerr << "error: unknown size '" << label << "'" << std::endl;
+                    return false;
+                }
+                settings.sizes.push_back(size);
+            }
+        } else if (arg == "--channels") {
+            settings.channels.clear();
+            for (const auto& item : splitList(value)) {
+                int channels = 0;
+                if (!parseNumber(item, channels) || (channels != 1 && channels != 3 && channels != 4)) {
+                    std::cerr << "error: channels must be 1, 3 or 4" << std::endl;
+                    return false;
+                }
+                settings.channels.push_back(channels);
+            }
+        } else if (arg == "--rois") {
+            settings.rois = splitList(value);
+            for (const auto& roi : settings.rois) {
+                if (roi != "full" && roi != "half" && roi != "tile") {
+                    std::cerr << "error: unknown roi '" << roi << "'" << std::endl;
+                    return false;
+                }
+            }
+        } else if (arg == "--ops") {
+            settings.operations = splitList(value);
+        } else if (arg == "--pipeline") {
+            settings.pipelines.push_back(value);
+        } else if (arg == "--tile") {
+            if (!parseNumber(value, settings.tile_size, 0)) {
+                std::cerr << "error: --tile expects a size" << std::endl;
+                return false;
+            }
+        } else if (arg == "--warmup") {
+            if (!parseNumber(value, settings.warmups, 0)) {
+                std::cerr << "error: --warmup expects a count" << std::endl;
+                return false;
+            }
+        } else if (arg == "--reps") {
+            if (!parseNumber(value, settings.repetitions, 1)) {
+                std::cerr << "error: --reps expects a count of at least 1" << std::endl;
+                return false;
+            }
+        } else if (arg == "--threads") {
+            if (!parseNumber(value, options.threads)) {
+                std::cerr << "error: --threads expects a count" << std::endl;
+                return false;
+            }
+        } else if (arg == "--output") {
+            options.output_file = value;
+        } else if (arg == "--baseline") {
+            options.baseline_file = value;
+        } else if (arg == "--tolerance") {
+            if (!parseNumber(value, options.tolerance, 0.0)) {
+                std::cerr << "error: --tolerance expects a non-negative fraction" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (settings.sizes.empty() || settings.channels.empty() || settings.rois.empty()
+        || settings.warmups < 0 || settings.repetitions <= 0) {
+        std::cerr << "error: nothing to measure" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// main function for the benchmark harness
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return -1;
+    }
+    if (options.show_help) {
+        printUsage(argv[0]);
+        return 0;
+    }
+
+    // cases run one image at a time, with the whole budget inside it
+    Scheduler::shared().setThreadBudget(options.threads);
+    Scheduler::shared().plan(1);
+
+    try {
+        std::vector<BenchResult> results;
+        if (options.run_operations) {
+            results = Benchmark::runOperations(options.settings);
+        }
+        auto pipeline_results = Benchmark::runPipelines(options.settings);
+        results.insert(results.end(), pipeline_results.begin(), pipeline_results.end());
+
+        Benchmark::printTable(results);
+
+        if (!options.output_file.empty()) {
+            std::ofstream out(options.output_file);
+            if (!out.is_open()) {
+                std::cerr << "error: could not write results to '" << options.output_file << "'" << std::endl;
+                return -1;
+            }
+            out << Benchmark::toJson(options.settings, results).dump(2) << std::endl;
+            std::cout << "results saved to: " << options.output_file << std::endl;
+        }
+
+        if (!options.baseline_file.empty()) {
+            std::ifstream in(options.baseline_file);
+            if (!in.is_open()) {
+                std::cerr << "error: could not open baseline '" << options.baseline_file << "'" << std::endl;
+                return -1;
+            }
+            nlohmann::json baseline = nlohmann::json::parse(in);
+
+            auto regressions = Benchmark::compare(baseline, results, options.tolerance);
+            for (const auto& regression : regressions) {
+                std::cout << "regression: " << regression.id << " p50 " << regression.baseline_p50 << " ms -> "
+                          << regression.current_p50 << " ms" << std::endl;
+            }
+            if (!regressions.empty()) {
+                return 1;
+            }
+            std::cout << "no regressions against " << options.baseline_file << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include <opencv2/opencv.hpp>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 // operation classes
 #include "src/cpp/operations/hpp/base_operation.hpp"
@@ -9,20 +13,414 @@
 // pipeline system
 #include "src/cpp/bindings/hpp/pipeline_reader.hpp"
 #include "src/cpp/bindings/hpp/operation_factory.hpp"
+#include "src/cpp/bindings/hpp/number_parser.hpp"
+#include "src/cpp/pipeline/hpp/pipeline_compiler.hpp"
+#include "src/cpp/pipeline/hpp/pipeline_executor.hpp"
+#include "src/cpp/pipeline/hpp/pipeline_optimizer.hpp"
+#include "src/cpp/pipeline/hpp/batch_runner.hpp"
+#include "src/cpp/pipeline/hpp/stream_runner.hpp"
+#include "src/cpp/pipeline/hpp/graph_executor.hpp"
+#include "src/cpp/pipeline/hpp/image_loader.hpp"
+#include "src/cpp/pipeline/hpp/image_writer.hpp"
+#include "src/cpp/pipeline/hpp/result_cache.hpp"
+#include "src/cpp/server/hpp/pipeline_server.hpp"
+#include "src/cpp/runtime/hpp/scheduler.hpp"
+#include "src/cpp/runtime/hpp/trace_recorder.hpp"
 
-// main function for json-driven pipeline execution
-int main(int argc, char* argv[]) {
-    // check command line arguments
-    if (argc != 4) {
-        std::cout << "usage: " << argv[0] << " <pipeline.json> <input_image> <output_image>" << std::endl;
-        std::cout << "example: " << argv[0] << " tests/json/test_pipeline.json data/input.jpg output.jpg" << std::endl;
+// command line options shared by all modes
+struct CliOptions {
+    bool batch = false;
+    size_t batch_workers = 0;
+    bool video = false;
+    bool optimize = true;
+    double blur_tolerance = 0.0;
+    bool explain = false;
+    bool fast_decode = false;
+    int tile_size = 0;
+    size_t queue_capacity = 4;
+    size_t threads = 0;
+    size_t encode_workers = 1;
+    EncodeOptions encode;
+    cv::Rect region;
+    std::string trace_file;
+    std::string result_cache;
+    uint64_t result_cache_mb = 1024;
+    bool result_cache_fast = false;
+    std::string serve_endpoint;
+    size_t step_cache_mb = 0;
+    std::vector<std::string> positional;
+};
+
+// print command line usage
+static void printUsage(const char* program) {
+    std::cout << "usage: " << program << " [options] <pipeline.json> <input_image> <output_image>" << std::endl;
+    std::cout << "       " << program << " [options] <graph.json> <input_image> <output_dir>" << std::endl;
+    std::cout << "       " << program << " [options] --batch <pipeline.json> <input_dir|glob|manifest> <output_dir> [workers]" << std::endl;
+    std::cout << "       " << program << " [options] --video <pipeline.json> <input_video|device> <output_video|pattern>" << std::endl;
+    std::cout << "       " << program << " [options] --serve <socket_path|->" << std::endl;
+    std::cout << "options:" << std::endl;
+    std::cout << "  --tile <size>   run chains of whole-image steps in size x size tiles across cores" << std::endl;
+    std::cout << "  --queue <n>     frames buffered between video stages, and batch results waiting for encode (default 4)" << std::endl;
+    std::cout << "  --threads <n>   thread budget shared by image workers and opencv (default: all cores)" << std::endl;
+    std::cout << "  --encode-workers <n>  batch and image sequence encode threads, 0 encodes on the image workers (default 1)" << std::endl;
+    std::cout << "  --jpeg-quality <0-100>   jpeg (and motion jpeg) quality (default 95)" << std::endl;
+    std::cout << "  --png-compression <0-9>  png zlib level (default 1)" << std::endl;
+    std::cout << "  --webp-quality <1-101>   webp quality, 101 for lossless (default 100)" << std::endl;
+    std::cout << "  --region <x,y,w,h>  compute only this window of the output (single image mode)" << std::endl;
+    std::cout << "  --result-cache <dir>  reuse outputs of earlier runs with the same input and pipeline (single and batch mode)" << std::endl;
+    std::cout << "  --result-cache-size <mb>  evict least recently used outputs beyond this size (default 1024)" << std::endl;
+    std::cout << "  --result-cache-fast  identify inputs by path, size and modification time instead of their bytes" << std::endl;
+    std::cout << "  --step-cache <mb>  keep intermediate images so reruns resume after the last unchanged step (server mode)" << std::endl;
+    std::cout << "  --trace <file>  record per-step timing and memory (.jsonl for json lines, otherwise chrome trace)" << std::endl;
+    std::cout << "  --explain       print the plan before and after optimization" << std::endl;
+    std::cout << "  --no-optimize   run the operations exactly as written" << std::endl;
+    std::cout << "  --blur-tolerance <levels>  merge consecutive blurs when no 8-bit pixel can change by more levels, counting rounding; below 1 never merges (default 0: never)" << std::endl;
+    std::cout << "  --fast-decode   decode jpegs at 1/2, 1/4 or 1/8 size when the pipeline starts by shrinking them" << std::endl;
+    std::cout << "example: " << program << " tests/json/test_pipeline.json data/input.jpg output.jpg" << std::endl;
+    std::cout << "example: " << program << " tests/json/test_graph.json data/input.jpg out/" << std::endl;
+    std::cout << "example: " << program << " --batch tests/json/test_pipeline.json \"data/*.jpg\" out/" << std::endl;
+    std::cout << "example: " << program << " --serve /tmp/sea_vision.sock" << std::endl;
+    std::cout << "example: " << program << " --video tests/json/test_pipeline.json data/clip.avi out/frame_%05d.jpg" << std::endl;
+}
+
+// split flags from positional arguments, false on a malformed flag
+static bool parseArguments(int argc, char* argv[], CliOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch") {
+            options.batch = true;
+        } else if (arg == "--video") {
+            options.video = true;
+        } else if (arg == "--explain") {
+            options.explain = true;
+        } else if (arg == "--fast-decode") {
+            options.fast_decode = true;
+        } else if (arg == "--result-cache-fast") {
+            options.result_cache_fast = true;
+        } else if (arg == "--result-cache") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            options.result_cache = argv[++i];
+        } else if (arg == "--result-cache-size") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            // in megabytes, bounded so the size in bytes fits
+            if (!parseNumber<uint64_t>(argv[++i], options.result_cache_mb, 1, UINT64_MAX >> 20)) {
+                return false;
+            }
+        } else if (arg == "--no-optimize") {
+            options.optimize = false;
+        } else if (arg == "--blur-tolerance") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.blur_tolerance, 0.0)) {
+                return false;
+            }
+        } else if (arg == "--tile") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.tile_size, 0)) {
+                return false;
+            }
+        } else if (arg == "--queue") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber<size_t>(argv[++i], options.queue_capacity, 1)) {
+                return false;
+            }
+        } else if (arg == "--threads") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.threads)) {
+                return false;
+            }
+        } else if (arg == "--encode-workers") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.encode_workers)) {
+                return false;
+            }
+        } else if (arg == "--jpeg-quality") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.encode.jpeg_quality, 0, 100)) {
+                return false;
+            }
+        } else if (arg == "--png-compression") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.encode.png_compression, 0, 9)) {
+                return false;
+            }
+        } else if (arg == "--webp-quality") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            if (!parseNumber(argv[++i], options.encode.webp_quality, 1, 101)) {
+                return false;
+            }
+        } else if (arg == "--region") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            cv::Rect& region = options.region;
+            char separator;
+            std::istringstream fields(argv[++i]);
+            if (!(fields >> region.x >> separator >> region.y >> separator >> region.width >> separator >> region.height)
+                || region.empty()) {
+                std::cerr << "error: --region expects x,y,width,height" << std::endl;
+                return false;
+            }
+        } else if (arg == "--serve") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            options.serve_endpoint = argv[++i];
+        } else if (arg == "--step-cache") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            // in megabytes, bounded so the size in bytes fits
+            if (!parseNumber<size_t>(argv[++i], options.step_cache_mb, 0, SIZE_MAX >> 20)) {
+                return false;
+            }
+        } else if (arg == "--trace") {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            options.trace_file = argv[++i];
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "error: unknown option '" << arg << "'" << std::endl;
+            return false;
+        } else {
+            options.positional.push_back(arg);
+        }
+    }
+    return true;
+}
+
+// recorder for --trace, nullptr when tracing is off
+static std::unique_ptr<TraceRecorder> makeTrace(const CliOptions& options) {
+    return options.trace_file.empty() ? nullptr : std::make_unique<TraceRecorder>();
+}
+
+// write the trace of a run when --trace was given
+static bool saveTrace(const CliOptions& options, const TraceRecorder* trace) {
+    if (!trace) {
+        return true;
+    }
+    if (!trace->save(options.trace_file)) {
+        std::cerr << "error: could not save trace to '" << options.trace_file << "'" << std::endl;
+        return false;
+    }
+    std::cout << "trace saved to: " << options.trace_file << std::endl;
+    return true;
+}
+
+// cache for --result-cache, nullptr when it is off
+static std::unique_ptr<ResultCache> makeResultCache(const CliOptions& options) {
+    if (options.result_cache.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<ResultCache>(options.result_cache, options.result_cache_mb << 20, options.result_cache_fast);
+}
+
+// batch mode: run one pipeline over many images on a worker pool
+static int runBatch(const CliOptions& options) {
+    const auto& args = options.positional;
+    std::string pipeline_file = args[0];
+    std::string input_spec = args[1];
+    std::string output_dir = args[2];
+    // without an explicit worker count the scheduler picks one from the thread budget
+    size_t workers = options.batch_workers;
+
+    std::cout << "starting sea vision batch pipeline..." << std::endl;
+    std::cout << "pipeline config: " << pipeline_file << std::endl;
+
+    try {
+        // parse the pipeline once for the whole batch
+        PipelineConfig config = PipelineReader::readPipeline(pipeline_file);
+
+        std::vector<BatchItem> items = BatchRunner::collectItems(input_spec, output_dir);
+        if (items.empty()) {
+            std::cerr << "error: no input images found for '" << input_spec << "'" << std::endl;
+            return -1;
+        }
+
+        std::cout << "processing " << items.size() << " images..." << std::endl;
+        auto trace = makeTrace(options);
+        BatchOptions batch_options;
+        batch_options.workers = workers;
+        batch_options.optimize = options.optimize;
+        batch_options.blur_tolerance = options.blur_tolerance;
+        batch_options.fast_decode = options.fast_decode;
+        batch_options.encode_workers = options.encode_workers;
+        batch_options.queue_capacity = options.queue_capacity;
+        batch_options.encode = options.encode;
+        batch_options.trace = trace.get();
+        auto result_cache = makeResultCache(options);
+        batch_options.result_cache = result_cache.get();
+
+        BatchResult result = BatchRunner::run(config, items, batch_options);
+        std::cout << "image workers: " << result.workers << ", opencv threads per image: "
+                  << result.threads_per_image << ", encode workers: " << result.encode_workers << std::endl;
+        if (result.encode_workers > 0) {
+            std::cout << "encode stage: busy " << result.encode_busy_seconds << " s, image workers blocked on it "
+                      << result.encode_wait_seconds << " s" << std::endl;
+        }
+        if (result_cache) {
+            std::cout << "result cache: " << result_cache->hits() << " hits, " << result_cache->misses() << " misses, "
+                      << (result_cache->bytes() >> 20) << " MB stored" << std::endl;
+        }
+
+        std::cout << "batch completed: " << result.succeeded << " succeeded, " << result.failed << " failed in "
+                  << result.seconds << " s" << std::endl;
+        if (!saveTrace(options, trace.get())) {
+            return -1;
+        }
+        return result.failed == 0 ? 0 : -1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
         return -1;
     }
+}
+
+// video mode: stream frames from a file or camera through decode, process and encode threads
+static int runVideo(const CliOptions& options) {
+    const auto& args = options.positional;
+    std::string pipeline_file = args[0];
+    std::string input = args[1];
+    std::string output = args[2];
+
+    std::cout << "starting sea vision video pipeline..." << std::endl;
+    std::cout << "pipeline config: " << pipeline_file << std::endl;
+    std::cout << "input: " << input << std::endl;
+    std::cout << "output: " << output << std::endl;
+
+    try {
+        PipelineConfig config = PipelineReader::readPipeline(pipeline_file);
 
+        StreamOptions stream_options;
+        stream_options.queue_capacity = options.queue_capacity;
+        stream_options.optimize = options.optimize;
+        stream_options.blur_tolerance = options.blur_tolerance;
+        stream_options.tile_size = options.tile_size;
+        stream_options.encode = options.encode;
+        stream_options.encode_workers = options.encode_workers;
+
+        auto trace = makeTrace(options);
+        stream_options.trace = trace.get();
+
+        StreamResult result = StreamRunner::run(config, input, output, stream_options);
+        StreamRunner::printReport(result);
+        if (!saveTrace(options, trace.get())) {
+            return -1;
+        }
+        return result.frames > 0 ? 0 : -1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+// server mode: answer pipeline requests on a unix socket or stdin/stdout until shut down
+static int runServer(const CliOptions& options) {
+    ServerOptions server_options;
+    server_options.endpoint = options.serve_endpoint;
+    server_options.optimize = options.optimize;
+    server_options.blur_tolerance = options.blur_tolerance;
+    server_options.tile_size = options.tile_size;
+    server_options.step_cache_bytes = options.step_cache_mb << 20;
+
+    try {
+        PipelineServer server(server_options);
+        return server.run();
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+// graph mode: one decoded image through named nodes, every node with an output_image
+// is written (relative paths under the output directory)
+static int runGraph(const CliOptions& options, const PipelineGraph& graph) {
+    std::string input_image = options.positional[1];
+    std::string output_dir = options.positional[2];
+
+    std::cout << "loading input image..." << std::endl;
+    cv::Mat image;
+    ImageLoader::read(input_image, image);
+    if (image.empty()) {
+        std::cerr << "error: could not load image '" << input_image << "'" << std::endl;
+        return -1;
+    }
+    std::cout << "successfully loaded image with size: " << image.cols << "x" << image.rows << std::endl;
+
+    // every node is planned for the size of the image it receives
+    OptimizeOptions rewrite;
+    rewrite.depth = image.depth();
+    rewrite.blur_tolerance = options.blur_tolerance;
+    CompiledGraph compiled = GraphExecutor::compile(graph, image.size(), options.optimize, rewrite);
+    for (const auto& node : compiled.nodes) {
+        std::string input = node.input < 0 ? PipelineReader::graph_input : compiled.nodes[node.input].name;
+        std::cout << "node '" << node.name << "' from '" << input << "': " << node.config.operations.size()
+                  << " operations (" << node.pipeline.steps.size() << " steps after fusion)" << std::endl;
+        if (options.explain) {
+            std::cout << PipelineOptimizer::describe(node.config);
+        }
+    }
+
+    // independent branches share the thread budget like the images of a batch
+    SchedulePlan split = Scheduler::shared().plan(GraphExecutor::branchCount(compiled));
+    std::cout << "executing graph with " << compiled.nodes.size() << " nodes, " << split.frame_workers
+              << " branch workers, opencv threads per branch: " << split.intra_threads << std::endl;
+
+    auto trace = makeTrace(options);
+    GraphExecutor executor(options.tile_size, trace.get());
+    std::map<std::string, cv::Mat> outputs = executor.run(compiled, image);
+
+    std::cout << "saving results..." << std::endl;
+    for (const auto& node : compiled.nodes) {
+        auto it = outputs.find(node.name);
+        if (it == outputs.end()) {
+            continue;
+        }
+        std::filesystem::path output_path = std::filesystem::path(output_dir) / node.config.output_image;
+        if (output_path.has_parent_path()) {
+            std::filesystem::create_directories(output_path.parent_path());
+        }
+        if (!ImageLoader::save(output_path.string(), it->second, options.encode.params())) {
+            std::cerr << "error: could not save image to '" << output_path.string() << "'" << std::endl;
+            return -1;
+        }
+        std::cout << "output saved to: " << output_path.string() << std::endl;
+    }
+
+    if (!saveTrace(options, trace.get())) {
+        return -1;
+    }
+
+    std::cout << "pipeline completed successfully!!" << std::endl;
+    return 0;
+}
+
+// single image mode
+static int runSingle(const CliOptions& options) {
     // get command line arguments
-    std::string pipeline_file = argv[1];
-    std::string input_image = argv[2];
-    std::string output_image = argv[3];
+    std::string pipeline_file = options.positional[0];
+    std::string input_image = options.positional[1];
+    std::string output_image = options.positional[2];
     
     std::cout << "starting sea vision json-driven pipeline..." << std::endl;
     std::cout << "pipeline config: " << pipeline_file << std::endl;
@@ -33,53 +431,100 @@ int main(int argc, char* argv[]) {
     try {
         // read pipeline configuration from json
         std::cout << "reading pipeline configuration..." << std::endl;
-        PipelineConfig config = PipelineReader::readPipeline(pipeline_file);
+        nlohmann::json pipeline_json = PipelineReader::readJson(pipeline_file);
+        if (PipelineReader::isGraph(pipeline_json)) {
+            return runGraph(options, PipelineReader::parseGraph(pipeline_json));
+        }
+        PipelineConfig config = PipelineReader::parsePipeline(pipeline_json);
+
+        // a pipeline that changes nothing needs no decode or encode, the file is copied
+        if (options.optimize && options.region.empty() && !options.explain && options.trace_file.empty()
+            && PipelineOptimizer::isIdentity(config)
+            && ImageLoader::copyUnchanged(input_image, output_image, options.encode.params())) {
+            std::cout << "the pipeline leaves the image unchanged, copied the input file" << std::endl;
+            std::cout << "pipeline completed successfully!!" << std::endl;
+            std::cout << "output saved to: " << output_image << std::endl;
+            return 0;
+        }
+
+        // an earlier run's output for the same input and pipeline is copied as it is
+        auto result_cache = options.region.empty() && !options.explain && options.trace_file.empty()
+                                ? makeResultCache(options) : nullptr;
+        std::string cache_key;
+        if (result_cache) {
+            cache_key = result_cache->key(input_image, output_image,
+                                          ResultCache::describe(config, options.fast_decode,
+                                                                options.optimize ? options.blur_tolerance : 0.0,
+                                                                options.encode.params()));
+            if (result_cache->fetch(cache_key, output_image)) {
+                std::cout << "found in the result cache, copied the stored output" << std::endl;
+                std::cout << "pipeline completed successfully!!" << std::endl;
+                std::cout << "output saved to: " << output_image << std::endl;
+                return 0;
+            }
+        }
         
-        // load input image
+        // load input image (at reduced size when --fast-decode allows it)
         std::cout << "loading input image..." << std::endl;
-        cv::Mat image = cv::imread(input_image);
+        cv::Mat image;
+        DecodePlan decode = ImageLoader::load(input_image, config, options.fast_decode, image);
         if (image.empty()) {
             std::cerr << "error: could not load image '" << input_image << "'" << std::endl;
             return -1;
         }
         
         std::cout << "successfully loaded image with size: " << image.cols << "x" << image.rows << std::endl;
+        if (decode.reduction > 1) {
+            std::cout << "decoded at 1/" << decode.reduction << " of " << decode.source_size.width << "x"
+                      << decode.source_size.height << ", the pipeline starts by shrinking it" << std::endl;
+        }
         
-        // execute pipeline
-        std::cout << "executing pipeline with " << config.operations.size() << " operations..." << std::endl;
-        cv::Mat result = image.clone();
-        
-        // execute operations
-        for (size_t i = 0; i < config.operations.size(); ++i) {
-            const auto& op_config = config.operations[i];
-            
-            std::cout << "  step " << (i + 1) << ": " << op_config.type << std::endl;
-            
-            // create operation using factory
-            auto operation = OperationFactory::createOperation(op_config.type);
-            if (!operation) {
-                std::cerr << "error: could not create operation of type '" << op_config.type << "'" << std::endl;
-                return -1;
-            }
-            
-            // determine roi to use
-            ROI roi_to_use = (op_config.roi.full_image) 
-                           ? config.global_roi 
-                           : op_config.roi;
-            
-            // execute operation
-            result = operation->execute(result, roi_to_use, op_config.parameters);
-            
-            std::cout << "operation " << (i + 1) << " completed successfully!!" << std::endl;
+        // rewrite the plan now that the input size is known (pixel-exact)
+        if (options.explain) {
+            std::cout << "plan as written:" << std::endl << PipelineOptimizer::describe(config);
+        }
+        config = decode.config;
+        if (options.optimize) {
+            OptimizeOptions rewrite;
+            rewrite.depth = image.depth();
+            rewrite.blur_tolerance = options.blur_tolerance;
+            config = PipelineOptimizer::optimize(config, image.size(), rewrite);
+        }
+        if (options.explain) {
+            std::cout << "optimized plan:" << std::endl << PipelineOptimizer::describe(config);
         }
         
+        // compile pipeline (creates operations, fuses pointwise runs)
+        CompiledPipeline pipeline = PipelineCompiler::compile(config);
+
+        // execute pipeline
+        std::cout << "executing pipeline with " << config.operations.size() << " operations (" << pipeline.steps.size() << " steps after fusion)..." << std::endl;
+        // a single image gets the whole thread budget for its tiles and opencv calls
+        Scheduler::shared().plan(1);
+
+        // the decoded image is not needed afterwards, so the executor may work in it directly
+        PipelineExecutor executor(true);
+        executor.setTileSize(options.tile_size);
+        auto trace = makeTrace(options);
+        executor.setTrace(trace.get());
+        // with --region only the pixels the window depends on are computed
+        cv::Mat result = options.region.empty() ? executor.runInPlace(pipeline, image)
+                                                : executor.runRegion(pipeline, image, options.region);
+        
         // save result
         std::cout << "saving result..." << std::endl;
-        if (!cv::imwrite(output_image, result)) {
+        if (!ImageLoader::save(output_image, result, options.encode.params())) {
             std::cerr << "error: could not save image to '" << output_image << "'" << std::endl;
             return -1;
         }
+        if (result_cache) {
+            result_cache->store(cache_key, output_image);
+        }
     
+        if (!saveTrace(options, trace.get())) {
+            return -1;
+        }
+
         std::cout << "pipeline completed successfully!!" << std::endl;
         std::cout << "output saved to: " << output_image << std::endl;
         
@@ -89,4 +534,51 @@ int main(int argc, char* argv[]) {
     }
     
     return 0;
+}
+
+// main function for json-driven pipeline execution
+int main(int argc, char* argv[]) {
+    // check command line arguments
+    CliOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return -1;
+    }
+    if (options.batch + options.video + !options.serve_endpoint.empty() > 1) {
+        std::cerr << "error: --batch, --video and --serve cannot be combined" << std::endl;
+        printUsage(argv[0]);
+        return -1;
+    }
+    Scheduler::shared().setThreadBudget(options.threads);
+
+    if (!options.serve_endpoint.empty()) {
+        if (!options.positional.empty()) {
+            printUsage(argv[0]);
+            return -1;
+        }
+        return runServer(options);
+    }
+
+    if (options.batch) {
+        if ((options.positional.size() != 3 && options.positional.size() != 4)
+            || (options.positional.size() == 4 && !parseNumber(options.positional[3], options.batch_workers))) {
+            printUsage(argv[0]);
+            return -1;
+        }
+        return runBatch(options);
+    }
+
+    if (options.video) {
+        if (options.positional.size() != 3) {
+            printUsage(argv[0]);
+            return -1;
+        }
+        return runVideo(options);
+    }
+
+    if (options.positional.size() != 3) {
+        printUsage(argv[0]);
+        return -1;
+    }
+    return runSingle(options);
 }
\ No newline at end of file
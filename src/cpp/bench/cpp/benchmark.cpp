@@ -0,0 +1,332 @@
+#include "../hpp/benchmark.hpp"
+#include "../../bindings/hpp/operation_factory.hpp"
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "../../pipeline/hpp/pipeline_compiler.hpp"
+#include "../../pipeline/hpp/pipeline_executor.hpp"
+#include "../../pipeline/hpp/pipeline_optimizer.hpp"
+#include "../../runtime/hpp/buffer_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double millisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // linear interpolation between the closest ranks of sorted samples
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.size() == 1) {
+            return sorted[0];
+        }
+        double rank = fraction * (sorted.size() - 1);
+        size_t lower = static_cast<size_t>(rank);
+        size_t upper = std::min(lower + 1, sorted.size() - 1);
+        return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+    }
+
+    std::string caseId(const std::string& kind, const std::string& name, const std::string& size_label,
+                       int channels, const std::string& roi) {
+        std::ostringstream id;
+        id << kind << "/" << name << "/" << size_label << "/c" << channels;
+        if (!roi.empty()) {
+            id << "/" << roi;
+        }
+        return id.str();
+    }
+}
+
+bool Benchmark::parseSize(const std::string& text, BenchSize& size) {
+    static const std::map<std::string, cv::Size> named = {
+        {"vga", cv::Size(640, 480)},
+        {"hd", cv::Size(1280, 720)},
+        {"fhd", cv::Size(1920, 1080)},
+        {"4k", cv::Size(3840, 2160)},
+        {"12mp", cv::Size(4000, 3000)},
+        {"50mp", cv::Size(8192, 6144)}
+    };
+
+    auto it = named.find(text);
+    if (it != named.end()) {
+        size = {text, it->second};
+        return true;
+    }
+
+    // explicit <width>x<height>
+    int width = 0;
+    int height = 0;
+    char separator = 0;
+    std::istringstream in(text);
+    if (in >> width >> separator >> height && separator == 'x' && in.eof() && width > 0 && height > 0) {
+        size = {text, cv::Size(width, height)};
+        return true;
+    }
+    return false;
+}
+
+std::vector<BenchSize> Benchmark::defaultSizes(bool all) {
+    std::vector<std::string> labels = {"vga", "fhd", "4k"};
+    if (all) {
+        labels = {"vga", "hd", "fhd", "4k", "12mp", "50mp"};
+    }
+
+    std::vector<BenchSize> sizes;
+    for (const auto& label : labels) {
+        BenchSize size;
+        parseSize(label, size);
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+std::vector<BenchResult> Benchmark::runOperations(const BenchSettings& settings) {
+    std::vector<std::string> types = settings.operations.empty() ? OperationFactory::availableOperations()
+                                                                 : settings.operations;
+    std::vector<BenchResult> results;
+
+    for (const auto& bench_size : settings.sizes) {
+        for (int channels : settings.channels) {
+            cv::Mat image = makeImage(bench_size.size, channels);
+
+            for (const auto& type : types) {
+                auto operation = OperationFactory::createOperation(type);
+                if (!operation) {
+                    std::cerr << "error: unknown operation '" << type << "'" << std::endl;
+                    continue;
+                }
+                auto parameters = defaultParameters(type, bench_size.size);
+                bool geometry = operation->footprint(parameters).kind == Footprint::Kind::Geometry;
+
+                for (const auto& roi_label : settings.rois) {
+                    // geometry-changing operations ignore the roi, one full-frame case is enough
+                    if (geometry && roi_label != "full") {
+                        continue;
+                    }
+                    ROI roi = makeROI(roi_label, bench_size.size);
+
+                    // steady state: outputs go back to a pool like they do in the executor
+                    BufferPool pool;
+                    BufferPool::Scope scope(pool);
+
+                    std::vector<double> samples;
+                    for (int i = 0; i < settings.warmups + settings.repetitions; ++i) {
+                        auto start = Clock::now();
+                        cv::Mat result = operation->execute(image, roi, parameters);
+                        double elapsed = millisecondsSince(start);
+                        pool.release(result);
+
+                        if (i >= settings.warmups) {
+                            samples.push_back(elapsed);
+                        }
+                    }
+
+                    BenchResult result;
+                    result.kind = "operation";
+                    result.name = type;
+                    result.size_label = bench_size.label;
+                    result.size = bench_size.size;
+                    result.channels = channels;
+                    result.roi = roi_label;
+                    result.id = caseId(result.kind, type, bench_size.label, channels, roi_label);
+                    result.stats = summarize(samples);
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+
+    return results;
+}
+
+std::vector<BenchResult> Benchmark::runPipelines(const BenchSettings& settings) {
+    std::vector<BenchResult> results;
+
+    for (const auto& pipeline_file : settings.pipelines) {
+        PipelineConfig config = PipelineReader::readPipeline(pipeline_file);
+        std::string name = std::filesystem::path(pipeline_file).filename().string();
+
+        for (const auto& bench_size : settings.sizes) {
+            // planning is per input size and happens once, outside the timed loop
+            CompiledPipeline pipeline = PipelineCompiler::compile(PipelineOptimizer::optimize(config, bench_size.size));
+
+            for (int channels : settings.channels) {
+                cv::Mat image = makeImage(bench_size.size, channels);
+                PipelineExecutor executor;
+                executor.setTileSize(settings.tile_size);
+
+                std::vector<double> samples;
+                for (int i = 0; i < settings.warmups + settings.repetitions; ++i) {
+                    auto start = Clock::now();
+                    cv::Mat result = executor.run(pipeline, image);
+                    double elapsed = millisecondsSince(start);
+                    executor.recycle(result);
+
+                    if (i >= settings.warmups) {
+                        samples.push_back(elapsed);
+                    }
+                }
+
+                BenchResult result;
+                result.kind = "pipeline";
+                result.name = name;
+                result.size_label = bench_size.label;
+                result.size = bench_size.size;
+                result.channels = channels;
+                result.roi = "config";
+                result.id = caseId(result.kind, name, bench_size.label, channels, "");
+                result.stats = summarize(samples);
+                results.push_back(result);
+            }
+        }
+    }
+
+    return results;
+}
+
+BenchStats Benchmark::summarize(std::vector<double> samples) {
+    BenchStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    stats.repetitions = static_cast<int>(samples.size());
+    stats.min = samples.front();
+    stats.max = samples.back();
+
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    stats.mean = sum / samples.size();
+
+    double squares = 0.0;
+    for (double sample : samples) {
+        squares += (sample - stats.mean) * (sample - stats.mean);
+    }
+    stats.stddev = std::sqrt(squares / samples.size());
+
+    stats.p50 = percentile(samples, 0.50);
+    stats.p90 = percentile(samples, 0.90);
+    stats.p99 = percentile(samples, 0.99);
+    return stats;
+}
+
+nlohmann::json Benchmark::toJson(const BenchSettings& settings, const std::vector<BenchResult>& results) {
+    nlohmann::json document;
+    document["opencv_version"] = CV_VERSION;
+    document["threads"] = cv::getNumThreads();
+    document["warmups"] = settings.warmups;
+    document["repetitions"] = settings.repetitions;
+
+    nlohmann::json cases = nlohmann::json::array();
+    for (const auto& result : results) {
+        double megapixels = result.size.area() / 1e6;
+        cases.push_back({
+            {"id", result.id},
+            {"kind", result.kind},
+            {"name", result.name},
+            {"size", result.size_label},
+            {"width", result.size.width},
+            {"height", result.size.height},
+            {"channels", result.channels},
+            {"roi", result.roi},
+            {"repetitions", result.stats.repetitions},
+            {"min_ms", result.stats.min},
+            {"mean_ms", result.stats.mean},
+            {"stddev_ms", result.stats.stddev},
+            {"p50_ms", result.stats.p50},
+            {"p90_ms", result.stats.p90},
+            {"p99_ms", result.stats.p99},
+            {"max_ms", result.stats.max},
+            {"megapixels_per_second", result.stats.p50 > 0.0 ? megapixels / (result.stats.p50 / 1000.0) : 0.0}
+        });
+    }
+    document["results"] = cases;
+    return document;
+}
+
+std::vector<BenchRegression> Benchmark::compare(const nlohmann::json& baseline, const std::vector<BenchResult>& results,
+                                                double tolerance) {
+    // medians are compared: the tail is too noisy to gate on
+    std::map<std::string, double> baseline_p50;
+    if (baseline.contains("results") && baseline["results"].is_array()) {
+        for (const auto& entry : baseline["results"]) {
+            if (entry.contains("id") && entry.contains("p50_ms")) {
+                baseline_p50[entry["id"].get<std::string>()] = entry["p50_ms"].get<double>();
+            }
+        }
+    }
+
+    std::vector<BenchRegression> regressions;
+    for (const auto& result : results) {
+        auto it = baseline_p50.find(result.id);
+        if (it != baseline_p50.end() && result.stats.p50 > it->second * (1.0 + tolerance)) {
+            regressions.push_back({result.id, it->second, result.stats.p50});
+        }
+    }
+    return regressions;
+}
+
+void Benchmark::printTable(const std::vector<BenchResult>& results) {
+    std::cout << std::left << std::setw(48) << "case" << std::right
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "min ms" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(48) << result.id << std::right
+                  << std::setw(10) << result.stats.p50 << std::setw(10) << result.stats.p90
+                  << std::setw(10) << result.stats.p99 << std::setw(10) << result.stats.min << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+cv::Mat Benchmark::makeImage(cv::Size size, int channels) {
+    cv::Mat image(size, CV_8UC(channels));
+    cv::RNG rng(0x5ea);
+    rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+    return image;
+}
+
+ROI Benchmark::makeROI(const std::string& label, cv::Size size) {
+    if (label == "half") {
+        return ROI(size.width / 4, size.height / 4, size.width / 2, size.height / 2, false);
+    }
+    if (label == "tile") {
+        int width = std::min(256, size.width);
+        int height = std::min(256, size.height);
+        return ROI((size.width - width) / 2, (size.height - height) / 2, width, height, false);
+    }
+    return ROI(0, 0, 0, 0, true);
+}
+
+std::map<std::string, double> Benchmark::defaultParameters(const std::string& type, cv::Size size) {
+    if (type == "brightness") {
+        return {{"factor", 1.2}};
+    }
+    if (type == "contrast") {
+        return {{"factor", 1.2}, {"brightness_offset", 10}};
+    }
+    if (type == "blur") {
+        return {{"kernel_size", 5}, {"sigma", 1.0}};
+    }
+    if (type == "sharpen") {
+        return {{"strength", 1.0}, {"kernel_size", 5}};
+    }
+    if (type == "crop") {
+        return {{"x", size.width / 4}, {"y", size.height / 4}, {"width", size.width / 2}, {"height", size.height / 2}};
+    }
+    if (type == "resize") {
+        return {{"scale", 0.5}};
+    }
+    // operations added later run with their own defaults
+    return {};
+}
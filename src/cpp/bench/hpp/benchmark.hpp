@@ -0,0 +1,106 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../../operations/hpp/base_operation.hpp"
+#include "../../../../include/json-develop/single_include/nlohmann/json.hpp"
+
+/**
+ * one named image size, e.g. vga = 640x480
+ */
+struct BenchSize {
+    std::string label;
+    cv::Size size;
+};
+
+/**
+ * what to measure and how often
+ */
+struct BenchSettings {
+    int warmups = 2;
+    int repetitions = 10;
+    std::vector<BenchSize> sizes;
+    std::vector<int> channels = {3};
+    std::vector<std::string> rois = {"full"};
+    std::vector<std::string> operations;   // empty = every registered operation
+    std::vector<std::string> pipelines;    // pipeline json files
+    int tile_size = 0;
+};
+
+/**
+ * timing summary of one case, in milliseconds
+ */
+struct BenchStats {
+    int repetitions = 0;
+    double min = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+/**
+ * one measured case
+ */
+struct BenchResult {
+    std::string id;        // stable key used to match against a baseline
+    std::string kind;      // "operation" or "pipeline"
+    std::string name;      // operation type or pipeline file
+    std::string size_label;
+    cv::Size size;
+    int channels = 3;
+    std::string roi;
+    BenchStats stats;
+};
+
+/**
+ * a case that got slower than its baseline
+ */
+struct BenchRegression {
+    std::string id;
+    double baseline_p50 = 0.0;
+    double current_p50 = 0.0;
+};
+
+// benchmark harness - times operations and whole pipelines on synthetic images
+class Benchmark {
+public:
+    // vga, hd, fhd, 4k, 12mp, 50mp, or an explicit <width>x<height>
+    static bool parseSize(const std::string& text, BenchSize& size);
+
+    // the default sweep, vga to 4k; "all" adds 12mp and 50mp
+    static std::vector<BenchSize> defaultSizes(bool all);
+
+    // time every selected operation for every size, channel count and roi
+    static std::vector<BenchResult> runOperations(const BenchSettings& settings);
+
+    // time every pipeline file end to end (optimize, compile once, run) for every size and channel count
+    static std::vector<BenchResult> runPipelines(const BenchSettings& settings);
+
+    // min / mean / percentiles of raw samples in milliseconds
+    static BenchStats summarize(std::vector<double> samples);
+
+    // results as a json document suitable for storing as a baseline
+    static nlohmann::json toJson(const BenchSettings& settings, const std::vector<BenchResult>& results);
+
+    // cases whose median grew by more than `tolerance` (0.1 = 10%) over the baseline document
+    static std::vector<BenchRegression> compare(const nlohmann::json& baseline, const std::vector<BenchResult>& results,
+                                                double tolerance);
+
+    // human-readable table
+    static void printTable(const std::vector<BenchResult>& results);
+
+private:
+    // deterministic noise image so every run measures the same pixels
+    static cv::Mat makeImage(cv::Size size, int channels);
+
+    // roi for a label: full, half (centred, half of each side) or tile (centred 256x256)
+    static ROI makeROI(const std::string& label, cv::Size size);
+
+    // representative parameters for an operation at a given image size
+    static std::map<std::string, double> defaultParameters(const std::string& type, cv::Size size);
+};
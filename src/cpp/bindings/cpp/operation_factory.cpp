@@ -1,12 +1,13 @@
 #include "../hpp/operation_factory.hpp"
-#include "../hpp/operations.hpp"
+#include "../../operations/hpp/operations.hpp"
 
 const std::map<std::string, OperationFactory::OperationCreator> OperationFactory::creators = {
     {"brightness", &OperationFactory::createBrightness},
     {"blur", &OperationFactory::createBlur},
     {"crop", &OperationFactory::createCrop},
     {"sharpen", &OperationFactory::createSharpen},
-    {"contrast", &OperationFactory::createContrast}
+    {"contrast", &OperationFactory::createContrast},
+    {"resize", &OperationFactory::createResize}
 };
 
 std::unique_ptr<Operation> OperationFactory::createOperation(const std::string& type) {
@@ -17,6 +18,14 @@ std::unique_ptr<Operation> OperationFactory::createOperation(const std::string&
     return nullptr;
 }
 
+std::vector<std::string> OperationFactory::availableOperations() {
+    std::vector<std::string> types;
+    for (const auto& [type, creator] : creators) {
+        types.push_back(type);
+    }
+    return types;
+}
+
 std::unique_ptr<Operation> OperationFactory::createBrightness() {
     return std::make_unique<BrightnessOperation>();
 }
@@ -36,3 +45,7 @@ std::unique_ptr<Operation> OperationFactory::createSharpen() {
 std::unique_ptr<Operation> OperationFactory::createContrast() {
     return std::make_unique<ContrastOperation>();
 }
+
+std::unique_ptr<Operation> OperationFactory::createResize() {
+    return std::make_unique<ResizeOperation>();
+}
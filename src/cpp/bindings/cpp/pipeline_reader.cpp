@@ -1,11 +1,18 @@
 #include "../hpp/pipeline_reader.hpp"
-#include "../../../include/json-develop/single_include/nlohmann/json.hpp"
+#include "../../../../include/json-develop/single_include/nlohmann/json.hpp"
 #include <fstream>
+#include <set>
 #include <stdexcept>
 
 using json = nlohmann::json;
 
+const char* const PipelineReader::graph_input = "input";
+
 PipelineConfig PipelineReader::readPipeline(const std::string& filename) {
+    return parsePipeline(readJson(filename));
+}
+
+json PipelineReader::readJson(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("could not open pipeline file: " + filename);
@@ -18,6 +25,10 @@ PipelineConfig PipelineReader::readPipeline(const std::string& filename) {
         throw std::runtime_error("invalid JSON in pipeline file: " + std::string(e.what()));
     }
     
+    return j;
+}
+
+PipelineConfig PipelineReader::parsePipeline(const json& j) {
     PipelineConfig config;
     
     // parse global roi
@@ -48,6 +59,97 @@ PipelineConfig PipelineReader::readPipeline(const std::string& filename) {
     return config;
 }
 
+bool PipelineReader::isGraph(const json& j) {
+    return j.is_object() && j.contains("nodes");
+}
+
+PipelineGraph PipelineReader::readGraph(const std::string& filename) {
+    return parseGraph(readJson(filename));
+}
+
+PipelineGraph PipelineReader::parseGraph(const json& j) {
+    PipelineGraph graph;
+    if (j.contains("input_image")) {
+        graph.input_image = j["input_image"];
+    }
+
+    // a flat pipeline is a graph of one node
+    if (!isGraph(j)) {
+        PipelineNode node;
+        node.name = "output";
+        node.input = graph_input;
+        node.pipeline = parsePipeline(j);
+        graph.nodes.push_back(std::move(node));
+        return graph;
+    }
+
+    if (!j["nodes"].is_array() || j["nodes"].empty()) {
+        throw std::runtime_error("pipeline 'nodes' must be a non-empty array");
+    }
+
+    // each node is a flat pipeline (operations, roi, output_image) plus its name and input
+    std::vector<PipelineNode> nodes;
+    bool has_output = false;
+    for (const auto& node_json : j["nodes"]) {
+        if (!node_json.is_object() || !node_json.contains("name") || !node_json["name"].is_string()) {
+            throw std::runtime_error("pipeline node must have 'name' field");
+        }
+
+        PipelineNode node;
+        node.name = node_json["name"];
+        node.input = node_json.value("input", std::string(graph_input));
+        node.pipeline = parsePipeline(node_json);
+        node.pipeline.input_image.clear();
+        has_output = has_output || !node.pipeline.output_image.empty();
+        nodes.push_back(std::move(node));
+    }
+
+    if (!has_output) {
+        throw std::runtime_error("pipeline graph has no node with an 'output_image'");
+    }
+
+    graph.nodes = sortNodes(std::move(nodes));
+    return graph;
+}
+
+std::vector<PipelineNode> PipelineReader::sortNodes(std::vector<PipelineNode> nodes) {
+    std::set<std::string> names;
+    for (const auto& node : nodes) {
+        if (node.name.empty() || node.name == graph_input) {
+            throw std::runtime_error("invalid pipeline node name: '" + node.name + "'");
+        }
+        if (!names.insert(node.name).second) {
+            throw std::runtime_error("duplicate pipeline node: " + node.name);
+        }
+    }
+    for (const auto& node : nodes) {
+        if (node.input != graph_input && names.count(node.input) == 0) {
+            throw std::runtime_error("pipeline node '" + node.name + "' reads from unknown node '" + node.input + "'");
+        }
+    }
+
+    // every node has one input, so repeatedly taking the nodes whose input is already
+    // placed orders the graph; a pass that places nothing means the rest form a cycle
+    std::vector<PipelineNode> sorted;
+    std::set<std::string> placed = {graph_input};
+    while (!nodes.empty()) {
+        std::vector<PipelineNode> waiting;
+        for (auto& node : nodes) {
+            if (placed.count(node.input)) {
+                placed.insert(node.name);
+                sorted.push_back(std::move(node));
+            } else {
+                waiting.push_back(std::move(node));
+            }
+        }
+        if (waiting.size() == nodes.size()) {
+            throw std::runtime_error("pipeline graph has a cycle through node '" + waiting.front().name + "'");
+        }
+        nodes = std::move(waiting);
+    }
+    return sorted;
+}
+
 ROI PipelineReader::parseROI(const json& roi_json) {
     ROI roi;
     
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+// parse all of `text` as a number in [min, max] (command line values); false, leaving
+// `value` alone, on anything else: empty text, trailing characters, overflow, nan, a sign
+// on an unsigned type
+template <typename T>
+bool parseNumber(const std::string& text, T& value, T min = std::numeric_limits<T>::lowest(),
+                 T max = std::numeric_limits<T>::max()) {
+    static_assert(std::is_arithmetic_v<T>, "parseNumber needs a number type");
+    if (text.empty() || std::isspace(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    T parsed;
+    if constexpr (std::is_floating_point_v<T>) {
+        long double number = std::strtold(begin, &end);
+        if (!std::isfinite(number) || number < min || number > max) {
+            return false;
+        }
+        parsed = static_cast<T>(number);
+    } else if constexpr (std::is_signed_v<T>) {
+        long long number = std::strtoll(begin, &end, 10);
+        if (number < static_cast<long long>(min) || number > static_cast<long long>(max)) {
+            return false;
+        }
+        parsed = static_cast<T>(number);
+    } else {
+        // strtoull would wrap "-1" around to the largest value
+        if (text[0] == '-') {
+            return false;
+        }
+        unsigned long long number = std::strtoull(begin, &end, 10);
+        if (number < static_cast<unsigned long long>(min) || number > static_cast<unsigned long long>(max)) {
+            return false;
+        }
+        parsed = static_cast<T>(number);
+    }
+    if (errno == ERANGE || end != begin + text.size()) {
+        return false;
+    }
+
+    value = parsed;
+    return true;
+}
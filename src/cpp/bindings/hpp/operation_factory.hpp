@@ -3,8 +3,9 @@
 #include <string>
 #include <memory>
 #include <map>
-#include "../operations/hpp/base_operation.hpp"
-#include "../operations/hpp/operations.hpp"
+#include <vector>
+#include "../../operations/hpp/base_operation.hpp"
+#include "../../operations/hpp/operations.hpp"
 
 // operation factory class
 class OperationFactory {
@@ -12,6 +13,9 @@ public:
     // create an operation based on type string
     static std::unique_ptr<Operation> createOperation(const std::string& type);
 
+    // type strings of every registered operation
+    static std::vector<std::string> availableOperations();
+
 private:
     using OperationCreator = std::unique_ptr<Operation>(*)();
     static const std::map<std::string, OperationCreator> creators;
@@ -21,4 +25,5 @@ private:
     static std::unique_ptr<Operation> createCrop();
     static std::unique_ptr<Operation> createSharpen();
     static std::unique_ptr<Operation> createContrast();
+    static std::unique_ptr<Operation> createResize();
 }; 
\ No newline at end of file
@@ -3,8 +3,8 @@
 #include <string>
 #include <vector>
 #include <map>
-#include "../operations/hpp/base_operation.hpp"
-#include "../../../include/json-develop/single_include/nlohmann/json.hpp"
+#include "../../operations/hpp/base_operation.hpp"
+#include "../../../../include/json-develop/single_include/nlohmann/json.hpp"
 
 /**
  * structure to hold operation configuration from JSON
@@ -25,16 +25,57 @@ struct PipelineConfig {
     std::string output_image;
 };
 
+/**
+ * named node of a pipeline graph: a chain of operations (with its own roi and optional
+ * output_image) applied to the result of another node or to the decoded input image
+ */
+struct PipelineNode {
+    std::string name;
+    std::string input;
+    PipelineConfig pipeline;
+};
+
+/**
+ * pipeline graph: one decoded input fanning out through named nodes to several outputs,
+ * nodes ordered so each comes after the node it reads from
+ */
+struct PipelineGraph {
+    std::string input_image;
+    std::vector<PipelineNode> nodes;
+};
+
 // json pipeline reader class
 class PipelineReader {
 public:
     // read pipeline configuration from json file
     static PipelineConfig readPipeline(const std::string& filename);
 
+    // parse pipeline configuration from an already parsed json document
+    static PipelineConfig parsePipeline(const nlohmann::json& pipeline_json);
+
+    // read a json document from file (throws on missing files and invalid json)
+    static nlohmann::json readJson(const std::string& filename);
+
+    // true if the document describes a graph ("nodes" array) rather than a flat pipeline
+    static bool isGraph(const nlohmann::json& pipeline_json);
+
+    // read a pipeline graph from json file
+    static PipelineGraph readGraph(const std::string& filename);
+
+    // parse a pipeline graph; a flat pipeline becomes a single node reading the input.
+    // throws on duplicate or unknown node names, cycles and graphs without outputs
+    static PipelineGraph parseGraph(const nlohmann::json& pipeline_json);
+
+    // name under which nodes refer to the decoded input image
+    static const char* const graph_input;
+
 private:
     // parse roi from json object
     static ROI parseROI(const nlohmann::json& roi_json);
     
     // parse operation configuration from json object
     static OperationConfig parseOperation(const nlohmann::json& op_json);
+
+    // order nodes so every node follows its input, checking the references on the way
+    static std::vector<PipelineNode> sortNodes(std::vector<PipelineNode> nodes);
 }; 
\ No newline at end of file
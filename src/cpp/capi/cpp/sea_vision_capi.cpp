@@ -0,0 +1,174 @@
+#include "../hpp/sea_vision.h"
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "../../pipeline/hpp/pipeline_compiler.hpp"
+#include "../../pipeline/hpp/pipeline_executor.hpp"
+#include "../../pipeline/hpp/pipeline_optimizer.hpp"
+#include "../../pipeline/hpp/plan_cache.hpp"
+#include <opencv2/opencv.hpp>
+#include <exception>
+#include <string>
+
+// the handle behind sv_plan: the parsed pipeline and its plans per input size
+struct sv_plan {
+    std::string text;
+    PipelineConfig config;
+    PlanCache plans;
+
+    sv_plan(std::string text, PipelineConfig config)
+        : text(std::move(text)), config(std::move(config)), plans(16, true) {}
+};
+
+namespace {
+    thread_local std::string last_error;
+
+    sv_status fail(sv_status status, const std::string& message) {
+        last_error = message;
+        return status;
+    }
+
+    // opencv type of a described image, false if it is not one the pipeline can take
+    bool imageType(const sv_image* image, int& type) {
+        if (!image || image->width <= 0 || image->height <= 0 || image->channels < 1 || image->channels > 4
+            || image->depth < SV_DEPTH_U8 || image->depth > SV_DEPTH_F64) {
+            return false;
+        }
+        type = CV_MAKETYPE(image->depth, image->channels);
+        return true;
+    }
+
+    // mat header over a caller's buffer, no copy
+    bool wrap(const sv_image* image, cv::Mat& mat) {
+        int type = 0;
+        if (!imageType(image, type) || !image->data
+            || image->stride < static_cast<size_t>(image->width) * CV_ELEM_SIZE(type)
+            || image->stride % CV_ELEM_SIZE1(type) != 0) {
+            return false;
+        }
+        mat = cv::Mat(image->height, image->width, type, image->data, image->stride);
+        return true;
+    }
+
+    // true if the pixel memory of two images intersects (the same buffer, or views into one)
+    bool overlaps(const cv::Mat& a, const cv::Mat& b) {
+        const uchar* a_end = a.ptr(a.rows - 1) + a.cols * a.elemSize();
+        const uchar* b_end = b.ptr(b.rows - 1) + b.cols * b.elemSize();
+        return a.data < b_end && b.data < a_end;
+    }
+
+    // copy between images that may share memory: overlapping ones go through a temporary
+    void copyImage(const cv::Mat& from, cv::Mat& to) {
+        if (overlaps(from, to)) {
+            from.clone().copyTo(to);
+        } else {
+            from.copyTo(to);
+        }
+    }
+}
+
+extern "C" {
+
+uint32_t sv_abi_version(void) {
+    return SEA_VISION_ABI_VERSION;
+}
+
+sv_status sv_plan_create(const char* json, size_t length, sv_plan** plan) {
+    if (!json || !plan) {
+        return fail(SV_ERROR_INVALID_ARGUMENT, "json and plan must not be null");
+    }
+    *plan = nullptr;
+
+    try {
+        std::string text = length == 0 ? std::string(json) : std::string(json, length);
+        nlohmann::json document = nlohmann::json::parse(text);
+        if (PipelineReader::isGraph(document)) {
+            return fail(SV_ERROR_PIPELINE, "pipeline graphs are not supported, create a plan per node");
+        }
+        PipelineConfig config = PipelineReader::parsePipeline(document);
+        PipelineCompiler::validate(config);
+
+        *plan = new sv_plan(document.dump(), std::move(config));
+    } catch (const std::exception& e) {
+        return fail(SV_ERROR_PIPELINE, e.what());
+    }
+    last_error.clear();
+    return SV_OK;
+}
+
+void sv_plan_destroy(sv_plan* plan) {
+    delete plan;
+}
+
+sv_status sv_plan_output_shape(const sv_plan* plan, const sv_image* input, sv_image* output) {
+    int type = 0;
+    if (!plan || !output || !imageType(input, type)) {
+        return fail(SV_ERROR_INVALID_ARGUMENT, "plan, input and output must be set and the input shape valid");
+    }
+
+    try {
+        cv::Size size = PipelineOptimizer::outputSize(plan->config, cv::Size(input->width, input->height));
+        output->width = size.width;
+        output->height = size.height;
+        output->channels = input->channels;
+        output->depth = input->depth;
+        output->stride = static_cast<size_t>(size.width) * CV_ELEM_SIZE(type);
+    } catch (const std::exception& e) {
+        return fail(SV_ERROR_PIPELINE, e.what());
+    }
+    last_error.clear();
+    return SV_OK;
+}
+
+sv_status sv_plan_execute(sv_plan* plan, const sv_image* input, sv_image* output) {
+    cv::Mat source;
+    cv::Mat target;
+    if (!plan || !wrap(input, source) || !wrap(output, target)) {
+        return fail(SV_ERROR_INVALID_ARGUMENT, "plan, input and output must be set with valid shapes, data and strides");
+    }
+
+    sv_image expected = *output;
+    sv_status status = sv_plan_output_shape(plan, input, &expected);
+    if (status != SV_OK) {
+        return status;
+    }
+    if (target.cols != expected.width || target.rows != expected.height || target.type() != source.type()) {
+        return fail(SV_ERROR_SHAPE, "output buffer must be " + std::to_string(expected.width) + "x"
+                    + std::to_string(expected.height) + " with the input's channels and depth");
+    }
+
+    try {
+        // one executor per calling thread, its buffer pool is reused across calls
+        thread_local PipelineExecutor executor;
+        std::shared_ptr<const CompiledPipeline> compiled = plan->plans.get(plan->text, source.size(), source.depth());
+
+        cv::Mat result;
+        if (target.size() == source.size()) {
+            // the output buffer is the working copy (or already holds the input, same layout)
+            if (target.data != source.data || target.step != source.step) {
+                copyImage(source, target);
+            }
+            cv::Mat working = target;
+            result = executor.runInPlace(*compiled, working);
+        } else {
+            result = executor.run(*compiled, source);
+        }
+
+        if (result.size() != target.size() || result.type() != target.type()) {
+            return fail(SV_ERROR_EXECUTION, "pipeline produced an unexpected output shape");
+        }
+        // the result may be a view into the input, which may share the output's memory
+        if (result.data != target.data || result.step != target.step) {
+            copyImage(result, target);
+        }
+        executor.recycle(result);
+    } catch (const std::exception& e) {
+        return fail(SV_ERROR_EXECUTION, e.what());
+    }
+    last_error.clear();
+    return SV_OK;
+}
+
+const char* sv_last_error(void) {
+    return last_error.c_str();
+}
+
+}
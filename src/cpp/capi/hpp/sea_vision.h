@@ -0,0 +1,102 @@
+#ifndef SEA_VISION_H
+#define SEA_VISION_H
+
+/*
+ * sea vision c api - the pipeline engine behind a stable c interface (libsea_vision).
+ *
+ * a plan is created once from pipeline json and executed on caller-owned pixel buffers,
+ * writing into a caller-owned output buffer; nothing is allocated for the caller and no
+ * c++ type or exception crosses the boundary. query the output shape first to size the
+ * output buffer. a plan may be executed from several threads at the same time.
+ *
+ *     sv_plan* plan = NULL;
+ *     if (sv_plan_create(json_text, 0, &plan) != SV_OK) { puts(sv_last_error()); }
+ *     sv_image output;
+ *     sv_plan_output_shape(plan, &input, &output);
+ *     output.data = malloc(output.stride * output.height);
+ *     sv_plan_execute(plan, &input, &output);
+ *     sv_plan_destroy(plan);
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(SEA_VISION_STATIC)
+#define SEA_VISION_API
+#elif defined(_WIN32)
+#ifdef SEA_VISION_BUILDING
+#define SEA_VISION_API __declspec(dllexport)
+#else
+#define SEA_VISION_API __declspec(dllimport)
+#endif
+#else
+#define SEA_VISION_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped on any incompatible change to the functions or structs below */
+#define SEA_VISION_ABI_VERSION 1
+
+typedef enum sv_status {
+    SV_OK = 0,
+    SV_ERROR_INVALID_ARGUMENT = 1, /* null pointer, unsupported type, bad stride */
+    SV_ERROR_PIPELINE = 2,         /* json or pipeline invalid (unknown operation, bad parameters) */
+    SV_ERROR_SHAPE = 3,            /* output buffer does not have the pipeline's output shape */
+    SV_ERROR_EXECUTION = 4         /* the pipeline failed while running */
+} sv_status;
+
+/* channel value types, numbered like opencv depths */
+typedef enum sv_depth {
+    SV_DEPTH_U8 = 0,
+    SV_DEPTH_S8 = 1,
+    SV_DEPTH_U16 = 2,
+    SV_DEPTH_S16 = 3,
+    SV_DEPTH_S32 = 4,
+    SV_DEPTH_F32 = 5,
+    SV_DEPTH_F64 = 6
+} sv_depth;
+
+/* a caller-owned image: rows of `stride` bytes, pixels of `channels` interleaved values
+   (bgr order for color images, as opencv uses) */
+typedef struct sv_image {
+    void* data;
+    size_t stride;      /* bytes from one row to the next, at least width * channels * value size */
+    int32_t width;
+    int32_t height;
+    int32_t channels;   /* 1 to 4 */
+    int32_t depth;      /* an sv_depth */
+} sv_image;
+
+/* compiled pipeline, opaque */
+typedef struct sv_plan sv_plan;
+
+/* SEA_VISION_ABI_VERSION of the loaded library */
+SEA_VISION_API uint32_t sv_abi_version(void);
+
+/* parse and validate pipeline json (`length` 0: null-terminated); the plan is compiled for
+   each input size on first use and kept */
+SEA_VISION_API sv_status sv_plan_create(const char* json, size_t length, sv_plan** plan);
+
+/* release a plan; null is ignored */
+SEA_VISION_API void sv_plan_destroy(sv_plan* plan);
+
+/* shape of the result for this input: fills width, height, channels, depth and the packed
+   stride of `output` and leaves its data pointer alone */
+SEA_VISION_API sv_status sv_plan_output_shape(const sv_plan* plan, const sv_image* input, sv_image* output);
+
+/* run the plan on `input`, writing into `output`, which must have the queried shape (any
+   stride). when the output has the input's shape it doubles as the working buffer, and it
+   may be the input buffer itself for in-place processing */
+SEA_VISION_API sv_status sv_plan_execute(sv_plan* plan, const sv_image* input, sv_image* output);
+
+/* message of the last error on this thread, "" if none */
+SEA_VISION_API const char* sv_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
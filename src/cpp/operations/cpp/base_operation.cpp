@@ -1,5 +1,33 @@
 #include "../hpp/base_operation.hpp"
+#include "../../runtime/hpp/buffer_pool.hpp"
+#include "../../runtime/hpp/trace_recorder.hpp"
 #include <iostream>
+#include <stdexcept>
+
+namespace {
+    // times the phases of one operation call when a trace recorder is current on this thread
+    class PhaseTrace {
+    public:
+        PhaseTrace()
+            : recorder(TraceRecorder::current()) {
+            if (recorder) {
+                begin = TraceRecorder::mark();
+            }
+        }
+
+        // record the phase since the previous one and start the next
+        void finish(const Operation& operation, const char* phase, const TraceShape& input, const TraceShape& output) {
+            if (recorder) {
+                recorder->record(operation.getName(), phase, begin, input, output);
+                begin = TraceRecorder::mark();
+            }
+        }
+
+    private:
+        TraceRecorder* recorder;
+        TraceRecorder::Mark begin;
+    };
+}
 
 // roi utility functions
 namespace ROITools {
@@ -14,7 +42,8 @@ namespace ROITools {
         if (roi.full_image) {
             return processed_roi;
         }
-        cv::Mat output = input.clone();
+        cv::Mat output = BufferPool::acquireScratch(input.size(), input.type());
+        input.copyTo(output);
         processed_roi.copyTo(output(cv::Rect(roi.x, roi.y, roi.width, roi.height)));
         return output;
     }
@@ -22,33 +51,170 @@ namespace ROITools {
 
 // base class implementation - non-virtual interface pattern
 cv::Mat Operation::execute(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& params) {
+    PhaseTrace trace;
+
     // pre-execution validation
-    if (!preExecute(input, roi, params)) {
+    bool ready = preExecute(input, roi, params);
+    trace.finish(*this, "preExecute", input, TraceShape());
+    if (!ready) {
         throw std::runtime_error("pre-execution validation failed for operation: " + getNameImpl());
     }
 
-    // parameter validation
-    if (!validateParameters(params)) {
+    // parameter validation (done once up front for prepared operations)
+    checkBound(params);
+    bool valid = prepared || validateParameters(params);
+    trace.finish(*this, "validateParameters", input, TraceShape());
+    if (!valid) {
         throw std::runtime_error("invalid parameters for operation: " + getNameImpl());
     }
 
     // execute operation
     cv::Mat result = executeImpl(input, roi, params);
+    trace.finish(*this, "executeImpl", input, result);
 
     // post-execution validation
-    if (!postExecute(input, result, roi, params)) {
+    bool passed = postExecute(input, result, roi, params);
+    trace.finish(*this, "postExecute", input, result);
+    if (!passed) {
         throw std::runtime_error("post-execution validation failed for operation: " + getNameImpl());
     }
 
     return result;
 }
 
+void Operation::executeInPlace(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& params) {
+    PhaseTrace trace;
+
+    // pre-execution validation
+    bool ready = preExecute(image, roi, params);
+    trace.finish(*this, "preExecute", image, TraceShape());
+    if (!ready) {
+        throw std::runtime_error("pre-execution validation failed for operation: " + getNameImpl());
+    }
+
+    // parameter validation (done once up front for prepared operations)
+    checkBound(params);
+    bool valid = prepared || validateParameters(params);
+    trace.finish(*this, "validateParameters", image, TraceShape());
+    if (!valid) {
+        throw std::runtime_error("invalid parameters for operation: " + getNameImpl());
+    }
+
+    // execute operation (the image may be swapped for a new buffer, so keep the input's shape for the trace)
+    TraceShape input_shape(image);
+    executeInPlaceImpl(image, roi, params);
+    trace.finish(*this, "executeInPlaceImpl", input_shape, image);
+
+    // post-execution validation (the input has been overwritten)
+    bool passed = postExecute(image, image, roi, params);
+    trace.finish(*this, "postExecute", image, image);
+    if (!passed) {
+        throw std::runtime_error("post-execution validation failed for operation: " + getNameImpl());
+    }
+}
+
+bool Operation::supportsInPlace() const {
+    return supportsInPlaceImpl();
+}
+
+bool Operation::supportsInPlaceImpl() const {
+    return false;
+}
+
+void Operation::executeInPlaceImpl(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& params) {
+    if (roi.full_image || !supportsInPlaceImpl()) {
+        // new buffer for the whole image: recycle the one it replaces
+        cv::Mat processed = executeImpl(image, roi, params);
+        if (processed.data != image.data) {
+            BufferPool::releaseScratch(image);
+        }
+        image = processed;
+        return;
+    }
+
+    // process the roi view only; it still sees its neighbours in the parent image,
+    // exactly like the extractROI view used by executeImpl
+    cv::Mat view = ROITools::extractROI(image, roi);
+    cv::Mat processed = executeImpl(view, ROI(0, 0, 0, 0, true), params);
+
+    if (processed.size() != view.size() || processed.type() != view.type()) {
+        throw std::runtime_error("in-place result does not match the roi for operation: " + getNameImpl());
+    }
+    processed.copyTo(view);
+    BufferPool::releaseScratch(processed);
+}
+
+Footprint Operation::footprint(const std::map<std::string, double>& params) const {
+    checkBound(params);
+    return footprintImpl(params);
+}
+
+Footprint Operation::footprintImpl(const std::map<std::string, double>& params) const {
+    return Footprint(Footprint::Kind::Geometry);
+}
+
 std::string Operation::getName() const {
     return getNameImpl();
 }
 
-bool Operation::validateParameters(const std::map<std::string, double>& parameters) const {
-    return validateParametersImpl(parameters);
+bool Operation::validateParameters(const std::map<std::string, double>& parameters, bool report) const {
+    return validateParametersImpl(parameters, report);
+}
+
+bool Operation::isPointwise() const {
+    return isPointwiseImpl();
+}
+
+bool Operation::isPointwiseImpl() const {
+    return false;
+}
+
+cv::Mat Operation::lookupTable(const std::map<std::string, double>& params) const {
+    if (prepared) {
+        checkBound(params);
+        return prepared_table;
+    }
+    return lookupTableImpl(params);
+}
+
+cv::Mat Operation::lookupTableImpl(const std::map<std::string, double>& params) const {
+    return cv::Mat();
+}
+
+void Operation::prepare(const std::map<std::string, double>& params) {
+    if (!validateParameters(params)) {
+        throw std::runtime_error("invalid parameters for operation: " + getNameImpl());
+    }
+
+    prepareImpl(params);
+    prepared_params = params;
+    bound_params = &params;
+
+    // pointwise operations resolve their table now instead of on every call
+    if (isPointwiseImpl()) {
+        prepared_table = lookupTableImpl(params);
+    }
+    prepared = true;
+}
+
+bool Operation::isPrepared() const {
+    return prepared;
+}
+
+void Operation::prepareImpl(const std::map<std::string, double>& params) {
+}
+
+void Operation::checkBound(const std::map<std::string, double>& params) const {
+#ifndef NDEBUG
+    // prepared state answers for the bound parameters only. compiled plans pass the very map they
+    // were prepared with, so only other maps are compared entry by entry, and only in debug builds:
+    // this runs for every step, frame and tile
+    if (prepared && &params != bound_params && params != prepared_params) {
+        throw std::runtime_error("operation " + getNameImpl() + " was prepared with different parameters");
+    }
+#else
+    (void)params;
+#endif
 }
 
 bool Operation::preExecute(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& params) const {
@@ -0,0 +1,115 @@
+#include "../hpp/fused_operation.hpp"
+#include "../hpp/lut_engine.hpp"
+#include "../../runtime/hpp/buffer_pool.hpp"
+#include <stdexcept>
+
+void FusedPointwiseOperation::addStage(std::unique_ptr<Operation> operation, const std::map<std::string, double>& params) {
+    if (!operation || !operation->isPointwise()) {
+        throw std::runtime_error("only pointwise operations can be fused");
+    }
+    stages.push_back({std::move(operation), params});
+}
+
+size_t FusedPointwiseOperation::stageCount() const {
+    return stages.size();
+}
+
+cv::Mat FusedPointwiseOperation::buildLookupTable() const {
+    cv::Mat table = LutEngine::identity();
+
+    for (const auto& stage : stages) {
+        cv::Mat stage_table = stage.operation->lookupTable(stage.params);
+        if (stage_table.empty()) {
+            // pointwise op without its own table: run it over the 0..255 ramp,
+            // which keeps the clamping between stages exact
+            stage_table = stage.operation->execute(LutEngine::identity(), ROI(0, 0, 0, 0, true), stage.params);
+        }
+        table = LutEngine::compose(table, stage_table);
+    }
+
+    return table;
+}
+
+cv::Mat FusedPointwiseOperation::executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) {
+    // extract ROI from input image
+    cv::Mat roi_image = ROITools::extractROI(input, roi);
+    cv::Mat output;
+
+    if (roi_image.depth() == CV_8U) {
+        // single pass: one table lookup per pixel for the whole chain
+        output = BufferPool::acquireScratch(roi_image.size(), roi_image.type());
+        LutEngine::apply(roi_image, lookupTable(parameters), output);
+    } else {
+        // no table for wider depths, run the stages back to back
+        output = roi_image;
+        for (auto& stage : stages) {
+            output = stage.operation->execute(output, ROI(0, 0, 0, 0, true), stage.params);
+        }
+    }
+
+    // apply the processed ROI back to the original image
+    return ROITools::applyROI(input, output, roi);
+}
+
+std::string FusedPointwiseOperation::getNameImpl() const {
+    std::string name;
+    for (const auto& stage : stages) {
+        if (!name.empty()) {
+            name += "+";
+        }
+        name += stage.operation->getName();
+    }
+    return name;
+}
+
+bool FusedPointwiseOperation::validateParametersImpl(const std::map<std::string, double>& parameters, bool report) const {
+    // each stage carries its own parameters
+    for (const auto& stage : stages) {
+        if (!stage.operation->validateParameters(stage.params, report)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FusedPointwiseOperation::prepareImpl(const std::map<std::string, double>& parameters) {
+    // wider depths still run the stages one by one
+    for (auto& stage : stages) {
+        stage.operation->prepare(stage.params);
+    }
+}
+
+bool FusedPointwiseOperation::isPointwiseImpl() const {
+    return true;
+}
+
+Footprint FusedPointwiseOperation::footprintImpl(const std::map<std::string, double>& parameters) const {
+    return Footprint(Footprint::Kind::Pointwise);
+}
+
+cv::Mat FusedPointwiseOperation::lookupTableImpl(const std::map<std::string, double>& parameters) const {
+    return buildLookupTable();
+}
+
+bool FusedPointwiseOperation::supportsInPlaceImpl() const {
+    for (const auto& stage : stages) {
+        if (!stage.operation->supportsInPlace()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FusedPointwiseOperation::executeInPlaceImpl(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& parameters) {
+    cv::Mat roi_view = ROITools::extractROI(image, roi);
+
+    if (roi_view.depth() == CV_8U) {
+        // single in-place pass over the roi
+        LutEngine::apply(roi_view, lookupTable(parameters), roi_view);
+    } else {
+        for (auto& stage : stages) {
+            stage.operation->executeInPlace(roi_view, ROI(0, 0, 0, 0, true), stage.params);
+        }
+    }
+}
@@ -0,0 +1,267 @@
+#include "../hpp/kernel_engine.hpp"
+#include "../../runtime/hpp/buffer_pool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace KernelEngine {
+    namespace {
+        // kernels are small, but keep the cache bounded for long-running processes
+        const size_t max_cached_kernels = 1024;
+
+        using KernelKey = std::tuple<int, double, int>;
+
+        std::mutex cache_mutex;
+        std::map<KernelKey, std::shared_ptr<const GaussianKernel>> kernel_cache;
+
+        // the coefficients cv::GaussianBlur uses on 8-bit images: the exact kernel scaled by 256
+        // and rounded from the outside in with the error carried along, the centre taking what is
+        // left so they sum to exactly 256
+        std::vector<int> fixedPointKernel(const cv::Mat& exact) {
+            const int n = exact.rows;
+            std::vector<int> fixed(n);
+            double error = 0.0;
+            int sum = 0;
+            for (int i = 0; i < n / 2; ++i) {
+                double adjusted = exact.at<double>(i) * 256.0 + error;
+                int value = cvRound(adjusted);
+                error = adjusted - value;
+                fixed[i] = value;
+                fixed[n - 1 - i] = value;
+                sum += value;
+            }
+            fixed[n / 2] = 256 - 2 * sum;
+            return fixed;
+        }
+
+        std::map<double, std::shared_ptr<const cv::Mat>> weight_cache;
+
+        // 256 x 256 table of the unsharp weighting for every (pixel, blurred) pair, with
+        // addWeighted's arithmetic on 8-bit data: single precision, one rounding at the end
+        std::shared_ptr<const cv::Mat> getWeightTable(double strength) {
+            {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto it = weight_cache.find(strength);
+                if (it != weight_cache.end()) {
+                    return it->second;
+                }
+            }
+
+            const float alpha = static_cast<float>(1.0 + strength);
+            const float beta = static_cast<float>(-strength);
+            auto table = std::make_shared<cv::Mat>(256, 256, CV_8U);
+            for (int pixel = 0; pixel < 256; ++pixel) {
+                uchar* row = table->ptr<uchar>(pixel);
+                for (int blurred = 0; blurred < 256; ++blurred) {
+                    row[blurred] = cv::saturate_cast<uchar>(static_cast<float>(pixel) * alpha + static_cast<float>(blurred) * beta);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (weight_cache.size() >= max_cached_kernels) {
+                weight_cache.clear();
+            }
+            weight_cache.emplace(strength, table);
+            return table;
+        }
+
+        // cv::GaussianBlur switches to its bit-exact fixed-point code for whole (not roi view) 8-bit images
+        bool usesFixedPoint(const cv::Mat& src) {
+            return src.depth() == CV_8U && !src.isSubmatrix();
+        }
+
+        // everything else, through the same calls cv::GaussianBlur ends up making
+        void filterBlur(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma) {
+            bool whole = !src.isSubmatrix();
+            if (src.depth() == CV_16U && whole) {
+                // 16-bit has its own bit-exact code
+                cv::GaussianBlur(src, dst, cv::Size(ksize, ksize), sigma);
+                return;
+            }
+            if (whole && (src.rows == 1 || src.cols == 1)) {
+                // single rows or columns shrink the kernel
+                cv::GaussianBlur(src, dst, cv::Size(ksize, ksize), sigma);
+                return;
+            }
+
+            std::shared_ptr<const GaussianKernel> kernel = getGaussian(ksize, sigma, src.depth());
+            cv::sepFilter2D(src, dst, src.depth(), kernel->coefficients, kernel->coefficients,
+                            cv::Point(-1, -1), 0, cv::BORDER_DEFAULT);
+        }
+
+        // fixed-point separable gaussian over output rows [begin, end) of an 8-bit image.
+        // the horizontal pass keeps the last ksize rows (reflected at the image edges) in a ring of
+        // 16-bit row buffers, the vertical pass sums them into 32 bits; both are exact integer sums,
+        // so the order of evaluation does not matter. `finish(y, start, count, sums)` turns the sums for
+        // elements [start, start + count) of row y into pixels
+        template <typename Finish>
+        void fixedPointRows(const cv::Mat& src, const std::vector<int>& kernel, int begin, int end, Finish finish) {
+            const int n = static_cast<int>(kernel.size());
+            const int radius = n / 2;
+            const int cn = src.channels();
+            const int width = src.cols;
+            const size_t len = static_cast<size_t>(width) * cn;
+            const size_t block = std::min<size_t>(len, 1024);
+
+            // source column of each border column of the padded row
+            std::vector<int> left(radius), right(radius);
+            for (int x = 0; x < radius; ++x) {
+                left[x] = cv::borderInterpolate(x - radius, width, cv::BORDER_REFLECT_101);
+                right[x] = cv::borderInterpolate(width + x, width, cv::BORDER_REFLECT_101);
+            }
+
+            std::vector<uchar> padded(len + static_cast<size_t>(2 * radius) * cn);
+            std::vector<uint16_t> ring(len * n);
+            std::vector<uint32_t> sums(block);
+            std::vector<const uint16_t*> window(n);
+            const int first = begin - radius;
+
+            auto horizontal = [&](int v) {
+                const uchar* row = src.ptr<uchar>(cv::borderInterpolate(v, src.rows, cv::BORDER_REFLECT_101));
+                std::memcpy(&padded[static_cast<size_t>(radius) * cn], row, len);
+                for (int x = 0; x < radius; ++x) {
+                    for (int c = 0; c < cn; ++c) {
+                        padded[static_cast<size_t>(x) * cn + c] = row[left[x] * cn + c];
+                        padded[len + static_cast<size_t>(radius + x) * cn + c] = row[right[x] * cn + c];
+                    }
+                }
+
+                // gaussian kernels are symmetric, so mirrored taps are added before weighting;
+                // every partial sum is at most 255 * 256, so 16 bits never overflow
+                uint16_t* out = &ring[static_cast<size_t>((v - first) % n) * len];
+                const uint16_t centre = static_cast<uint16_t>(kernel[radius]);
+                const uchar* middle = &padded[static_cast<size_t>(radius) * cn];
+                for (size_t i = 0; i < len; ++i) {
+                    out[i] = static_cast<uint16_t>(centre * middle[i]);
+                }
+                for (int j = 0; j < radius; ++j) {
+                    const uint16_t k = static_cast<uint16_t>(kernel[j]);
+                    const uchar* a = &padded[static_cast<size_t>(j) * cn];
+                    const uchar* b = &padded[static_cast<size_t>(n - 1 - j) * cn];
+                    for (size_t i = 0; i < len; ++i) {
+                        out[i] = static_cast<uint16_t>(out[i] + k * (a[i] + b[i]));
+                    }
+                }
+            };
+
+            for (int v = first; v < begin + radius; ++v) {
+                horizontal(v);
+            }
+
+            for (int y = begin; y < end; ++y) {
+                horizontal(y + radius);
+
+                for (int j = 0; j < n; ++j) {
+                    window[j] = &ring[static_cast<size_t>((y - radius + j - first) % n) * len];
+                }
+
+                // vertical sums in blocks that stay in cache, at most 255 * 256 * 256
+                for (size_t start = 0; start < len; start += block) {
+                    const size_t count = std::min(block, len - start);
+                    const uint32_t centre = static_cast<uint32_t>(kernel[radius]);
+                    const uint16_t* middle = window[radius] + start;
+                    for (size_t i = 0; i < count; ++i) {
+                        sums[i] = centre * middle[i];
+                    }
+                    for (int j = 0; j < radius; ++j) {
+                        const uint32_t k = static_cast<uint32_t>(kernel[j]);
+                        const uint16_t* a = window[j] + start;
+                        const uint16_t* b = window[n - 1 - j] + start;
+                        for (size_t i = 0; i < count; ++i) {
+                            sums[i] += k * (static_cast<uint32_t>(a[i]) + b[i]);
+                        }
+                    }
+                    finish(y, start, count, sums.data());
+                }
+            }
+        }
+
+        // row stripes for the worker threads, each long enough to amortize its ksize warm-up rows
+        template <typename Finish>
+        void fixedPointImage(const cv::Mat& src, const std::vector<int>& kernel, Finish finish) {
+            const int rows = src.rows;
+            const int stripes = std::max(1, std::min(cv::getNumThreads(), rows / (4 * static_cast<int>(kernel.size()))));
+            cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+                for (int s = range.start; s < range.end; ++s) {
+                    int begin = static_cast<int>(static_cast<int64_t>(rows) * s / stripes);
+                    int end = static_cast<int>(static_cast<int64_t>(rows) * (s + 1) / stripes);
+                    fixedPointRows(src, kernel, begin, end, finish);
+                }
+            });
+        }
+    }
+
+    std::shared_ptr<const GaussianKernel> getGaussian(int ksize, double sigma, int depth) {
+        sigma = std::max(sigma, 0.0);
+        KernelKey key(ksize, sigma, depth);
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = kernel_cache.find(key);
+            if (it != kernel_cache.end()) {
+                return it->second;
+            }
+        }
+
+        // build outside the lock, a duplicate build on a race is harmless
+        auto kernel = std::make_shared<GaussianKernel>();
+        kernel->coefficients = cv::getGaussianKernel(ksize, sigma, std::max(depth, CV_32F));
+        if (depth == CV_8U) {
+            kernel->fixed = fixedPointKernel(cv::getGaussianKernel(ksize, sigma, CV_64F));
+        }
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (kernel_cache.size() >= max_cached_kernels) {
+            kernel_cache.clear();
+        }
+        kernel_cache.emplace(key, kernel);
+        return kernel;
+    }
+
+    void gaussianBlur(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma) {
+        if (!usesFixedPoint(src)) {
+            filterBlur(src, dst, ksize, sigma);
+            return;
+        }
+
+        std::shared_ptr<const GaussianKernel> kernel = getGaussian(ksize, sigma, CV_8U);
+        cv::Mat input = src.data == dst.data ? src.clone() : src;
+        dst.create(input.size(), input.type());
+
+        fixedPointImage(input, kernel->fixed, [&dst](int y, size_t start, size_t count, const uint32_t* sums) {
+            uchar* out = dst.ptr<uchar>(y) + start;
+            for (size_t i = 0; i < count; ++i) {
+                // round away the 16 fraction bits; the kernels sum to one, so this stays within 0..255
+                out[i] = static_cast<uchar>((sums[i] + (1u << 15)) >> 16);
+            }
+        });
+    }
+
+    void unsharpMask(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma, double strength) {
+        if (!usesFixedPoint(src)) {
+            cv::Mat blurred = BufferPool::acquireScratch(src.size(), src.type());
+            filterBlur(src, blurred, ksize, sigma);
+            cv::addWeighted(src, 1.0 + strength, blurred, -strength, 0, dst);
+            BufferPool::releaseScratch(blurred);
+            return;
+        }
+
+        std::shared_ptr<const GaussianKernel> kernel = getGaussian(ksize, sigma, CV_8U);
+        cv::Mat input = src.data == dst.data ? src.clone() : src;
+        dst.create(input.size(), input.type());
+
+        std::shared_ptr<const cv::Mat> weights = getWeightTable(strength);
+        const uchar* table = weights->ptr<uchar>();
+        fixedPointImage(input, kernel->fixed, [&input, &dst, table](int y, size_t start, size_t count, const uint32_t* sums) {
+            const uchar* in = input.ptr<uchar>(y) + start;
+            uchar* out = dst.ptr<uchar>(y) + start;
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t blurred = (sums[i] + (1u << 15)) >> 16;
+                out[i] = table[(static_cast<size_t>(in[i]) << 8) | blurred];
+            }
+        });
+    }
+}
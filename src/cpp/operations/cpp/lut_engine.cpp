@@ -0,0 +1,70 @@
+#include "../hpp/lut_engine.hpp"
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace LutEngine {
+    namespace {
+        // tables are tiny, but keep the cache bounded for long-running processes
+        const size_t max_cached_tables = 4096;
+
+        using TableKey = std::pair<std::string, std::vector<double>>;
+
+        std::mutex cache_mutex;
+        std::map<TableKey, cv::Mat> table_cache;
+    }
+
+    cv::Mat getTable(const std::string& name, const std::vector<double>& values, const ValueMapper& mapper) {
+        TableKey key(name, values);
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = table_cache.find(key);
+            if (it != table_cache.end()) {
+                return it->second;
+            }
+        }
+
+        // build outside the lock, a duplicate build on a race is harmless
+        cv::Mat table(1, 256, CV_8U);
+        uchar* data = table.ptr<uchar>();
+        for (int i = 0; i < 256; ++i) {
+            data[i] = mapper(i);
+        }
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (table_cache.size() >= max_cached_tables) {
+            table_cache.clear();
+        }
+        table_cache.emplace(std::move(key), table);
+        return table;
+    }
+
+    void apply(const cv::Mat& src, const cv::Mat& table, cv::Mat& dst) {
+        CV_Assert(src.depth() == CV_8U && table.total() == 256 && table.type() == CV_8U);
+
+        // cv::LUT is element-wise, vectorized and parallel for large images,
+        // and safe when dst shares its data with src
+        cv::LUT(src, table, dst);
+    }
+
+    cv::Mat compose(const cv::Mat& first, const cv::Mat& second) {
+        cv::Mat result(1, 256, CV_8U);
+        const uchar* a = first.ptr<uchar>();
+        const uchar* b = second.ptr<uchar>();
+        uchar* out = result.ptr<uchar>();
+        for (int i = 0; i < 256; ++i) {
+            out[i] = b[a[i]];
+        }
+        return result;
+    }
+
+    cv::Mat identity() {
+        cv::Mat result(1, 256, CV_8U);
+        uchar* out = result.ptr<uchar>();
+        for (int i = 0; i < 256; ++i) {
+            out[i] = static_cast<uchar>(i);
+        }
+        return result;
+    }
+}
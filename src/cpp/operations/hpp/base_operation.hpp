@@ -16,6 +16,21 @@ struct ROI {
         : x(x), y(y), width(width), height(height), full_image(full_image) {}
 };
 
+// spatial footprint of an operation, used to plan tiled and region-limited execution
+struct Footprint {
+    enum class Kind {
+        Pointwise,      // output pixel depends only on the same input pixel
+        Neighbourhood,  // output pixel depends on input pixels within radius
+        Geometry        // output size or layout differs from the input (e.g. crop)
+    };
+
+    Kind kind;
+    int radius;
+
+    Footprint(Kind kind = Kind::Geometry, int radius = 0)
+        : kind(kind), radius(radius) {}
+};
+
 // roi utility functions
 namespace ROITools {
     // extract roi from image
@@ -32,12 +47,39 @@ public:
  
     // public non-virtual interface - execute the operation on the input image
     cv::Mat execute(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& params);
+
+    // public non-virtual interface - execute leaving the result in a caller-owned image; roi-limited
+    // operations write into the existing buffer, whole-image ones may swap in a new (pooled) buffer
+    void executeInPlace(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& params);
+
+    // public non-virtual interface - true if executeInPlace avoids copying the whole image
+    bool supportsInPlace() const;
+
+    // public non-virtual interface - spatial footprint of the operation for the given parameters
+    Footprint footprint(const std::map<std::string, double>& params) const;
  
     // public non-virtual interface - get the name/type of this operation
     std::string getName() const;
  
-    // public non-virtual interface - validate parameters for this operation
-    bool validateParameters(const std::map<std::string, double>& parameters) const;
+    // public non-virtual interface - validate parameters for this operation; errors are printed
+    // unless `report` is false
+    bool validateParameters(const std::map<std::string, double>& parameters, bool report = true) const;
+
+    // public non-virtual interface - true if each output pixel depends only on the same input pixel
+    bool isPointwise() const;
+
+    // public non-virtual interface - 1x256 table equivalent to this operation on 8-bit data, empty if it has none
+    cv::Mat lookupTable(const std::map<std::string, double>& params) const;
+
+    // public non-virtual interface - bind the operation to its parameters once, when a plan is compiled:
+    // validates them (throws if invalid) and precomputes what depends on them alone (tables, kernels).
+    // a prepared operation skips validation and must be run with the same parameters from then on,
+    // ideally the same map object; debug builds throw on a call with others (execute, footprint,
+    // lookupTable) instead of answering for the bound ones
+    void prepare(const std::map<std::string, double>& params);
+
+    // public non-virtual interface - true once prepare has run
+    bool isPrepared() const;
 
 protected:
     // pre-execution validation hook
@@ -54,5 +96,33 @@ private:
     virtual std::string getNameImpl() const = 0;
 
     // private virtual interface - validate parameters for this operation
-    virtual bool validateParametersImpl(const std::map<std::string, double>& parameters) const = 0;
+    virtual bool validateParametersImpl(const std::map<std::string, double>& parameters, bool report) const = 0;
+
+    // private virtual interface - report whether this operation is a per-pixel mapping
+    virtual bool isPointwiseImpl() const;
+
+    // private virtual interface - build the 8-bit lookup table for table-driven operations
+    virtual cv::Mat lookupTableImpl(const std::map<std::string, double>& params) const;
+
+    // private virtual interface - opt in to in-place execution (operations that only touch their roi)
+    virtual bool supportsInPlaceImpl() const;
+
+    // private virtual interface - in-place execution; the default runs executeImpl on the roi view
+    // and copies the result back into it, pointwise operations override it to write directly
+    virtual void executeInPlaceImpl(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& params);
+
+    // private virtual interface - report the footprint; the default (geometry) is never tiled
+    virtual Footprint footprintImpl(const std::map<std::string, double>& params) const;
+
+    // private virtual interface - precompute parameter-only state; the default does nothing
+    virtual void prepareImpl(const std::map<std::string, double>& params);
+
+    // debug builds: throws if the operation is prepared and `params` are not the ones it was bound to
+    void checkBound(const std::map<std::string, double>& params) const;
+
+    // set by prepare, read-only afterwards so prepared operations can be shared between threads
+    bool prepared = false;
+    std::map<std::string, double> prepared_params;
+    const std::map<std::string, double>* bound_params = nullptr; // the map prepare was given, compared by address only
+    cv::Mat prepared_table;
 }; 
\ No newline at end of file
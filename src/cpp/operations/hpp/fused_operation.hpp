@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "base_operation.hpp"
+
+// chain of pointwise operations collapsed into a single pass over the image
+class FusedPointwiseOperation : public Operation {
+public:
+    // append a pointwise operation and its parameters to the end of the chain
+    void addStage(std::unique_ptr<Operation> operation, const std::map<std::string, double>& params);
+
+    // number of operations collapsed into this one
+    size_t stageCount() const;
+
+private:
+    struct Stage {
+        std::unique_ptr<Operation> operation;
+        std::map<std::string, double> params;
+    };
+
+    std::vector<Stage> stages;
+
+    cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
+    std::string getNameImpl() const override;
+    bool validateParametersImpl(const std::map<std::string, double>& parameters, bool report) const override;
+    bool isPointwiseImpl() const override;
+    Footprint footprintImpl(const std::map<std::string, double>& parameters) const override;
+    cv::Mat lookupTableImpl(const std::map<std::string, double>& parameters) const override;
+    bool supportsInPlaceImpl() const override;
+    void executeInPlaceImpl(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& parameters) override;
+    void prepareImpl(const std::map<std::string, double>& parameters) override;
+
+    // build the composed 256-entry table for 8-bit inputs
+    cv::Mat buildLookupTable() const;
+};
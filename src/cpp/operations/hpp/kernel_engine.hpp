@@ -0,0 +1,27 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+
+// separable gaussian kernels shared by blur and sharpen
+namespace KernelEngine {
+    // 1-d gaussian coefficients for one (ksize, sigma, depth)
+    struct GaussianKernel {
+        cv::Mat coefficients;   // ksize x 1, as cv::getGaussianKernel for the depth's filter type
+        std::vector<int> fixed; // 8-bit images only: coefficients in 8-bit fixed point, summing to 256
+    };
+
+    // get the kernel for (ksize, sigma, depth), building it the first time it is seen;
+    // sigma <= 0 derives it from ksize like cv::GaussianBlur does
+    std::shared_ptr<const GaussianKernel> getGaussian(int ksize, double sigma, int depth);
+
+    // same result as cv::GaussianBlur(src, dst, Size(ksize, ksize), sigma) with the default border;
+    // whole 8-bit images take the cached fixed-point separable path
+    void gaussianBlur(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma);
+
+    // same result as blurring into a temporary and then
+    // cv::addWeighted(src, 1 + strength, blurred, -strength, 0, dst); whole 8-bit images
+    // are done in one pass over row buffers without the blurred image
+    void unsharpMask(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma, double strength);
+}
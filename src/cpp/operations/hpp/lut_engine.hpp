@@ -0,0 +1,25 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 8-bit lookup table utilities shared by pointwise operations
+namespace LutEngine {
+    // maps one 8-bit input value (0..255) to its output value
+    using ValueMapper = std::function<uchar(int)>;
+
+    // get the 1x256 table for an operation and its resolved parameter values,
+    // building it with the mapper the first time this parameter set is seen
+    cv::Mat getTable(const std::string& name, const std::vector<double>& values, const ValueMapper& mapper);
+
+    // apply a 1x256 table to an 8-bit image (dst may be src for an in-place pass)
+    void apply(const cv::Mat& src, const cv::Mat& table, cv::Mat& dst);
+
+    // compose two tables so that result[i] = second[first[i]]
+    cv::Mat compose(const cv::Mat& first, const cv::Mat& second);
+
+    // identity table (result[i] = i)
+    cv::Mat identity();
+}
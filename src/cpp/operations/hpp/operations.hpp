@@ -1,43 +1,109 @@
 #pragma once
 
-#include "base_operation.hpp"
+#include "typed_operation.hpp"
+
+// parameters of the brightness operation
+struct BrightnessParams {
+    double factor = 1.0;
+};
+
+// parameters of the blur operation (kernel_size is made odd when bound)
+struct BlurParams {
+    int kernel_size = 5;
+    double sigma = 1.0;
+};
+
+// parameters of the contrast operation
+struct ContrastParams {
+    double factor = 1.0;
+    double brightness_offset = 0.0;
+};
+
+// parameters of the crop operation; a width or height of 0 means "up to the image edge"
+// (explicit values are validated positive)
+struct CropParams {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// parameters of the sharpen operation (kernel_size is made odd when bound)
+struct SharpenParams {
+    double strength = 1.0;
+    int kernel_size = 5;
+};
+
+// parameters of the resize operation; an explicit width or height overrides the scale,
+// and giving only one of them keeps the aspect ratio
+struct ResizeParams {
+    double scale = 1.0;
+    int width = 0;
+    int height = 0;
+};
 
 // brightness adjustment operation (parameter: factor)
-class BrightnessOperation : public Operation {
+class BrightnessOperation : public TypedOperation<BrightnessParams> {
 private:
     cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
     std::string getNameImpl() const override;
-    bool validateParametersImpl(const std::map<std::string, double>& parameters) const override;
+    const ParamSchema<Params>& schema() const override;
+    bool isPointwiseImpl() const override;
+    cv::Mat lookupTableImpl(const std::map<std::string, double>& parameters) const override;
+    bool supportsInPlaceImpl() const override;
+    void executeInPlaceImpl(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& parameters) override;
+    Footprint footprintImpl(const std::map<std::string, double>& parameters) const override;
 };
 
 // blur operation (parameters: kernel_size, sigma)
-class BlurOperation : public Operation {
+class BlurOperation : public TypedOperation<BlurParams> {
 private:
     cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
     std::string getNameImpl() const override;
-    bool validateParametersImpl(const std::map<std::string, double>& parameters) const override;
+    const ParamSchema<Params>& schema() const override;
+    bool supportsInPlaceImpl() const override;
+    Footprint footprintImpl(const std::map<std::string, double>& parameters) const override;
 };
 
 // contrast adjustment operation (parameters: factor, brightness_offset)
-class ContrastOperation : public Operation {
+class ContrastOperation : public TypedOperation<ContrastParams> {
 private:
     cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
     std::string getNameImpl() const override;
-    bool validateParametersImpl(const std::map<std::string, double>& parameters) const override;
+    const ParamSchema<Params>& schema() const override;
+    bool isPointwiseImpl() const override;
+    cv::Mat lookupTableImpl(const std::map<std::string, double>& parameters) const override;
+    bool supportsInPlaceImpl() const override;
+    void executeInPlaceImpl(cv::Mat& image, const ROI& roi, const std::map<std::string, double>& parameters) override;
+    Footprint footprintImpl(const std::map<std::string, double>& parameters) const override;
 };
 
 // crop operation (parameters: x, y, width, height)
-class CropOperation : public Operation {
+class CropOperation : public TypedOperation<CropParams> {
 private:
     cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
     std::string getNameImpl() const override;
-    bool validateParametersImpl(const std::map<std::string, double>& parameters) const override;
+    const ParamSchema<Params>& schema() const override;
 };
 
 // sharpen operation (parameters: strength, kernel_size)
-class SharpenOperation : public Operation {
+class SharpenOperation : public TypedOperation<SharpenParams> {
 private:
     cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
     std::string getNameImpl() const override;
-    bool validateParametersImpl(const std::map<std::string, double>& parameters) const override;
-}; 
\ No newline at end of file
+    const ParamSchema<Params>& schema() const override;
+    bool supportsInPlaceImpl() const override;
+    Footprint footprintImpl(const std::map<std::string, double>& parameters) const override;
+};
+
+// resize operation (parameters: scale, width, height), area averaging when shrinking
+class ResizeOperation : public TypedOperation<ResizeParams> {
+public:
+    // size of the result for an input of the given size
+    static cv::Size targetSize(const std::map<std::string, double>& parameters, cv::Size input_size);
+
+private:
+    cv::Mat executeImpl(const cv::Mat& input, const ROI& roi, const std::map<std::string, double>& parameters) override;
+    std::string getNameImpl() const override;
+    const ParamSchema<Params>& schema() const override;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include "base_operation.hpp"
+
+// one parameter of an operation's schema: its json name, the range check on the raw value
+// (with the message printed when it fails) and where the value lands in the typed struct
+template <typename Params>
+struct ParamField {
+    const char* name;
+    bool (*valid)(double value);
+    const char* error;
+    void (*assign)(Params& params, double value);
+};
+
+// fixed table of fields describing a typed parameter struct, normally a constexpr array
+// defined next to the operation; unknown keys in a parameter map are ignored
+template <typename Params>
+class ParamSchema {
+public:
+    template <size_t N>
+    constexpr ParamSchema(const ParamField<Params> (&fields)[N]) : fields(fields), count(N) {}
+
+    // check every parameter present in the map, reporting the first one out of range (unless
+    // `report` is false, for callers that only ask whether the parameters would pass)
+    bool validate(const std::map<std::string, double>& parameters, bool report = true) const {
+        for (size_t i = 0; i < count; ++i) {
+            auto it = parameters.find(fields[i].name);
+            if (it != parameters.end() && !fields[i].valid(it->second)) {
+                if (report) {
+                    std::cerr << fields[i].error << std::endl;
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the struct's defaults, overridden by the parameters present in the map
+    Params bind(const std::map<std::string, double>& parameters) const {
+        Params params;
+        for (size_t i = 0; i < count; ++i) {
+            auto it = parameters.find(fields[i].name);
+            if (it != parameters.end()) {
+                fields[i].assign(params, it->second);
+            }
+        }
+        return params;
+    }
+
+private:
+    const ParamField<Params>* fields;
+    size_t count;
+};
+
+// operation whose parameters are a plain struct described by a schema; prepare binds the
+// struct once, so a prepared operation never looks its parameters up by name while running
+template <typename P>
+class TypedOperation : public Operation {
+public:
+    using Params = P;
+
+protected:
+    // parameters for this call: the bound struct once prepared (the public interface has checked
+    // that the map is the one it was bound from), otherwise bound from the map (unprepared
+    // callers such as the benchmarks still pass plain maps)
+    Params resolve(const std::map<std::string, double>& parameters) const {
+        return isPrepared() ? bound : schema().bind(parameters);
+    }
+
+private:
+    // set by prepare, read-only afterwards
+    Params bound;
+
+    // private virtual interface - the schema of this operation's parameters
+    virtual const ParamSchema<Params>& schema() const = 0;
+
+    bool validateParametersImpl(const std::map<std::string, double>& parameters, bool report) const override {
+        return schema().validate(parameters, report);
+    }
+
+    void prepareImpl(const std::map<std::string, double>& parameters) override {
+        bound = schema().bind(parameters);
+    }
+};
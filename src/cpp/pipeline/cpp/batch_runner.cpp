@@ -0,0 +1,264 @@
+#include "../hpp/batch_runner.hpp"
+#include "../hpp/pipeline_executor.hpp"
+#include "../hpp/pipeline_optimizer.hpp"
+#include "../../runtime/hpp/scheduler.hpp"
+#include "../../runtime/hpp/thread_pool.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+std::vector<BatchItem> BatchRunner::collectItems(const std::string& input_spec, const std::string& output_dir) {
+    std::vector<std::string> inputs;
+    std::vector<BatchItem> items;
+
+    fs::path spec_path(input_spec);
+    std::string file_pattern = spec_path.filename().string();
+
+    if (fs::is_directory(spec_path)) {
+        // every image file directly inside the directory
+        for (const auto& entry : fs::directory_iterator(spec_path)) {
+            if (entry.is_regular_file() && isImageFile(entry.path().string())) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+    } else if (file_pattern.find_first_of("*?") != std::string::npos) {
+        // glob over the file names of one directory
+        fs::path directory = spec_path.has_parent_path() ? spec_path.parent_path() : fs::path(".");
+        if (!fs::is_directory(directory)) {
+            throw std::runtime_error("batch input directory does not exist: " + directory.string());
+        }
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (entry.is_regular_file() && matchesWildcard(entry.path().filename().string(), file_pattern)) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+    } else if (fs::is_regular_file(spec_path)) {
+        // manifest: one "<input> [output]" per line, '#' starts a comment
+        std::ifstream manifest(input_spec);
+        if (!manifest.is_open()) {
+            throw std::runtime_error("could not open batch manifest: " + input_spec);
+        }
+
+        std::string line;
+        while (std::getline(manifest, line)) {
+            std::istringstream fields(line);
+            std::string input;
+            std::string output;
+            if (!(fields >> input) || input[0] == '#') {
+                continue;
+            }
+            fields >> output;
+            if (output.empty()) {
+                output = (fs::path(output_dir) / fs::path(input).filename()).string();
+            }
+            items.push_back({input, output});
+        }
+        return items;
+    } else {
+        throw std::runtime_error("batch input is not a directory, glob or manifest: " + input_spec);
+    }
+
+    // stable order so runs are reproducible
+    std::sort(inputs.begin(), inputs.end());
+    for (const auto& input : inputs) {
+        items.push_back({input, (fs::path(output_dir) / fs::path(input).filename()).string()});
+    }
+
+    return items;
+}
+
+BatchRunner::PlanSet::PlanSet(const PipelineConfig& config, const BatchOptions& options)
+    : config(config), optimize(options.optimize), blur_tolerance(options.blur_tolerance),
+      fast_decode(options.fast_decode), identity(options.optimize && PipelineOptimizer::isIdentity(config)),
+      cache_description(ResultCache::describe(config, options.fast_decode, options.optimize ? options.blur_tolerance : 0.0,
+                                              options.encode.params())) {}
+
+bool BatchRunner::PlanSet::isIdentity() const {
+    return identity;
+}
+
+const std::string& BatchRunner::PlanSet::description() const {
+    return cache_description;
+}
+
+DecodePlan BatchRunner::PlanSet::load(const std::string& path, cv::Mat& image) const {
+    return ImageLoader::load(path, config, fast_decode, image);
+}
+
+const CompiledPipeline& BatchRunner::PlanSet::forDecode(const DecodePlan& decode, int depth) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // without the optimizer a full decode's plan does not depend on the size or depth; a
+    // reduced decode's rewritten resize always depends on the encoded size
+    cv::Size size = optimize ? decode.decoded_size : cv::Size();
+    cv::Size source = decode.reduction > 1 ? decode.source_size : cv::Size();
+    depth = optimize ? depth : CV_8U;
+    auto key = std::make_tuple(size.width, size.height, depth, decode.reduction, source.width, source.height);
+    auto it = plans.find(key);
+    if (it == plans.end()) {
+        OptimizeOptions rewrite;
+        rewrite.depth = depth;
+        rewrite.blur_tolerance = blur_tolerance;
+        PipelineConfig sized = optimize ? PipelineOptimizer::optimize(decode.config, decode.decoded_size, rewrite) : decode.config;
+        it = plans.emplace(key, std::make_unique<CompiledPipeline>(PipelineCompiler::compile(sized))).first;
+    }
+    return *it->second;
+}
+
+BatchResult BatchRunner::run(const PipelineConfig& config, const std::vector<BatchItem>& items, const BatchOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    // operations hold no per-frame state, so every worker shares the compiled pipelines
+    PlanSet plans(config, options);
+
+    std::atomic<size_t> succeeded{0};
+    std::atomic<size_t> failed{0};
+
+    SchedulePlan split = Scheduler::shared().plan(items.size(), options.workers, options.encode_workers);
+
+    BatchResult result;
+    {
+        std::unique_ptr<ImageWriter> writer;
+        if (options.encode_workers > 0) {
+            writer = std::make_unique<ImageWriter>(options.encode_workers, options.queue_capacity, options.encode);
+        }
+
+        ThreadPool pool(split.frame_workers);
+        for (const auto& item : items) {
+            pool.submit([&plans, &item, &options, &writer, &succeeded, &failed] {
+                if (processItem(plans, item, options, writer.get())) {
+                    ++succeeded;
+                } else {
+                    ++failed;
+                }
+            });
+        }
+        pool.wait();
+
+        // queued images only count once they are on disk
+        if (writer) {
+            WriterStats written = writer->finish();
+            succeeded -= written.failed;
+            failed += written.failed;
+            result.encode_workers = options.encode_workers;
+            result.encode_busy_seconds = written.busy_seconds;
+            result.encode_wait_seconds = written.submit_wait_seconds;
+        }
+    }
+
+    result.succeeded = succeeded;
+    result.failed = failed;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.workers = split.frame_workers;
+    result.threads_per_image = split.intra_threads;
+    return result;
+}
+
+bool BatchRunner::processItem(PlanSet& plans, const BatchItem& item, const BatchOptions& options, ImageWriter* writer) {
+    try {
+        fs::path output_path(item.output_image);
+        if (output_path.has_parent_path()) {
+            fs::create_directories(output_path.parent_path());
+        }
+
+        // nothing to compute: the encoded file is the result
+        if (plans.isIdentity() && ImageLoader::copyUnchanged(item.input_image, item.output_image, options.encode.params())) {
+            return true;
+        }
+
+        // a stored result of the same input and pipeline is copied as it is
+        ResultCache* cache = options.result_cache;
+        std::string cache_key = cache ? cache->key(item.input_image, item.output_image, plans.description()) : std::string();
+        if (cache && cache->fetch(cache_key, item.output_image)) {
+            return true;
+        }
+
+        // one executor per worker thread, its buffer pool is reused across frames
+        thread_local PipelineExecutor executor;
+        thread_local cv::Size last_size;
+        executor.setTrace(options.trace);
+
+        // decode into a recycled buffer (reused when the frame size repeats)
+        cv::Mat image = last_size.empty() ? cv::Mat() : executor.bufferPool().acquire(last_size, CV_8UC3);
+        DecodePlan decode = plans.load(item.input_image, image);
+        if (image.empty()) {
+            std::cerr << "error: could not load image '" << item.input_image << "'" << std::endl;
+            return false;
+        }
+        last_size = image.size();
+
+        cv::Mat result = executor.runInPlace(plans.forDecode(decode, image.depth()), image);
+
+        // the writer holds on to the result until it is encoded, so it is not recycled
+        if (writer) {
+            std::function<void()> stored;
+            if (cache) {
+                stored = [cache, cache_key, output = item.output_image] { cache->store(cache_key, output); };
+            }
+            return writer->submit(item.output_image, result, std::move(stored));
+        }
+
+        bool written = ImageLoader::save(item.output_image, result, options.encode.params());
+        executor.recycle(result);
+        if (!written) {
+            std::cerr << "error: could not save image to '" << item.output_image << "'" << std::endl;
+            return false;
+        }
+        if (cache) {
+            cache->store(cache_key, item.output_image);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << item.input_image << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool BatchRunner::isImageFile(const std::string& path) {
+    std::string extension = fs::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    static const std::vector<std::string> image_extensions = {
+        ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp", ".ppm", ".pgm", ".svraw"
+    };
+    return std::find(image_extensions.begin(), image_extensions.end(), extension) != image_extensions.end();
+}
+
+bool BatchRunner::matchesWildcard(const std::string& name, const std::string& pattern) {
+    // iterative matcher with single-star backtracking
+    size_t n = 0;
+    size_t p = 0;
+    size_t star = std::string::npos;
+    size_t star_match = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++n;
+            ++p;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_match = n;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            n = ++star_match;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
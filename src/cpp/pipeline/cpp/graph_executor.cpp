@@ -0,0 +1,163 @@
+#include "../hpp/graph_executor.hpp"
+#include "../hpp/pipeline_executor.hpp"
+#include "../hpp/pipeline_optimizer.hpp"
+#include "../../runtime/hpp/scheduler.hpp"
+#include "../../runtime/hpp/thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+CompiledGraph GraphExecutor::compile(const PipelineGraph& graph, cv::Size input_size, bool optimize,
+                                     const OptimizeOptions& options) {
+    CompiledGraph compiled;
+    std::map<std::string, int> index;
+    std::vector<cv::Size> output_sizes;
+
+    for (const auto& node : graph.nodes) {
+        CompiledNode compiled_node;
+        compiled_node.name = node.name;
+
+        if (node.input != PipelineReader::graph_input) {
+            auto it = index.find(node.input);
+            if (it == index.end()) {
+                throw std::runtime_error("pipeline node '" + node.name + "' comes before its input '" + node.input + "'");
+            }
+            compiled_node.input = it->second;
+        }
+
+        // each node is planned for the size its input will have, so crops keep moving forward
+        compiled_node.input_size = compiled_node.input < 0 ? input_size : output_sizes[compiled_node.input];
+        compiled_node.config = optimize ? PipelineOptimizer::optimize(node.pipeline, compiled_node.input_size, options)
+                                        : node.pipeline;
+        compiled_node.pipeline = PipelineCompiler::compile(compiled_node.config);
+
+        if (compiled_node.input < 0) {
+            ++compiled.image_consumers;
+        } else {
+            ++compiled.nodes[compiled_node.input].consumers;
+        }
+        output_sizes.push_back(PipelineOptimizer::outputSize(compiled_node.config, compiled_node.input_size));
+        index[node.name] = static_cast<int>(compiled.nodes.size());
+        compiled.nodes.push_back(std::move(compiled_node));
+    }
+
+    return compiled;
+}
+
+size_t GraphExecutor::branchCount(const CompiledGraph& graph) {
+    size_t leaves = 0;
+    for (const auto& node : graph.nodes) {
+        if (node.consumers == 0) {
+            ++leaves;
+        }
+    }
+    return std::max<size_t>(leaves, 1);
+}
+
+GraphExecutor::GraphExecutor(int tile_size, TraceRecorder* trace)
+    : tile_size(tile_size), trace(trace) {}
+
+std::map<std::string, cv::Mat> GraphExecutor::run(const CompiledGraph& graph, cv::Mat& image) {
+    const size_t count = graph.nodes.size();
+
+    // nodes reading each node's result, and how many of them have not finished with it;
+    // the decoded image is tracked alongside, in the last slot
+    std::vector<std::vector<size_t>> readers(count);
+    std::vector<size_t> roots;
+    std::vector<size_t> remaining(count + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        int input = graph.nodes[i].input;
+        if (input < 0) {
+            roots.push_back(i);
+        } else {
+            readers[input].push_back(i);
+        }
+        remaining[input < 0 ? count : static_cast<size_t>(input)]++;
+    }
+
+    std::vector<cv::Mat> results(count);
+    std::mutex mutex;
+
+    auto process = [&](size_t i) {
+        const CompiledNode& node = graph.nodes[i];
+        const size_t source = node.input < 0 ? count : static_cast<size_t>(node.input);
+        cv::Mat& source_image = node.input < 0 ? image : results[source];
+
+        // the only reader of an intermediate takes its buffer over; readers of shared
+        // results and of outputs work on a copy
+        bool kept = node.input >= 0 && !graph.nodes[source].config.output_image.empty();
+        size_t source_readers = node.input < 0 ? graph.image_consumers : graph.nodes[source].consumers;
+        bool in_place = !kept && source_readers == 1;
+
+        cv::Mat input;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            input = source_image;
+            if (in_place) {
+                source_image.release();
+            }
+        }
+
+        cv::Mat result = runNode(node, input, in_place);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results[i] = result;
+        if (--remaining[source] == 0 && !kept) {
+            source_image.release();
+        }
+    };
+
+    size_t workers = std::min(Scheduler::shared().current().frame_workers, branchCount(graph));
+    if (workers <= 1) {
+        // nodes are in dependency order, so one pass runs the whole graph
+        for (size_t i = 0; i < count; ++i) {
+            process(i);
+        }
+    } else {
+        // a finished node releases its readers to the pool, so branches run as soon as
+        // their shared prefix is done
+        std::exception_ptr error;
+        ThreadPool pool(workers);
+        std::function<void(size_t)> schedule = [&](size_t i) {
+            pool.submit([&, i] {
+                try {
+                    process(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    return;
+                }
+                for (size_t reader : readers[i]) {
+                    schedule(reader);
+                }
+            });
+        };
+        for (size_t root : roots) {
+            schedule(root);
+        }
+        pool.wait();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::map<std::string, cv::Mat> outputs;
+    for (size_t i = 0; i < count; ++i) {
+        if (!graph.nodes[i].config.output_image.empty()) {
+            outputs[graph.nodes[i].name] = results[i];
+        }
+    }
+    return outputs;
+}
+
+cv::Mat GraphExecutor::runNode(const CompiledNode& node, cv::Mat& input, bool in_place) const {
+    // nodes may run on any worker, so each gets its own executor and buffer pool
+    PipelineExecutor executor;
+    executor.setTileSize(tile_size);
+    executor.setTrace(trace);
+    return in_place ? executor.runInPlace(node.pipeline, input) : executor.run(node.pipeline, input);
+}
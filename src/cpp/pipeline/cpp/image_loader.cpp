@@ -0,0 +1,324 @@
+#include "../hpp/image_loader.hpp"
+#include "../hpp/pipeline_optimizer.hpp"
+#include "../../operations/hpp/operations.hpp"
+#include "../../runtime/hpp/raw_image_file.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // what a jpeg's headers say about its decode
+    struct JpegInfo {
+        cv::Size size;
+        int precision = 0;      // bits per sample
+        int components = 0;     // 1 gray, 3 color, 4 cmyk
+        int orientation = 1;    // exif orientation, 0 if an exif block could not be read
+    };
+
+    // exif orientation tag of an APP1 segment's contents, 1 when absent, 0 when malformed
+    int exifOrientation(const std::vector<unsigned char>& segment) {
+        static const unsigned char exif_marker[6] = {'E', 'x', 'i', 'f', 0, 0};
+        if (segment.size() < 6 || !std::equal(exif_marker, exif_marker + 6, segment.begin())) {
+            return 1;
+        }
+        const unsigned char* tiff = segment.data() + 6;
+        const size_t size = segment.size() - 6;
+        if (size < 8 || (tiff[0] != tiff[1]) || (tiff[0] != 'I' && tiff[0] != 'M')) {
+            return 0;
+        }
+        const bool little = tiff[0] == 'I';
+        auto read16 = [&](size_t at) {
+            return little ? tiff[at] | (tiff[at + 1] << 8) : (tiff[at] << 8) | tiff[at + 1];
+        };
+        auto read32 = [&](size_t at) {
+            return static_cast<size_t>(little ? read16(at) | (read16(at + 2) << 16) : (read16(at) << 16) | read16(at + 2));
+        };
+
+        // ifd0: a count, then 12-byte entries of tag, type, count and value
+        size_t ifd = read32(4);
+        if (ifd + 2 > size) {
+            return 0;
+        }
+        size_t entries = static_cast<size_t>(read16(ifd));
+        if (ifd + 2 + entries * 12 > size) {
+            return 0;
+        }
+        for (size_t i = 0; i < entries; ++i) {
+            size_t entry = ifd + 2 + i * 12;
+            if (read16(entry) == 0x0112) {
+                return read16(entry + 8);
+            }
+        }
+        return 1;
+    }
+
+    bool readJpegInfo(const std::string& path, JpegInfo& info) {
+        std::ifstream file(path, std::ios::binary);
+        if (file.get() != 0xFF || file.get() != 0xD8) {
+            return false;
+        }
+
+        // walk the marker segments up to the first frame header (SOFn)
+        while (file) {
+            if (file.get() != 0xFF) {
+                return false;
+            }
+            int marker = file.get();
+            while (marker == 0xFF) {
+                marker = file.get();
+            }
+            if (marker < 0 || marker == 0xD9 || marker == 0xDA) {
+                return false;
+            }
+            if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+                continue;
+            }
+
+            int length_high = file.get();
+            int length_low = file.get();
+            int length = (length_high << 8) | length_low;
+            if (!file || length < 2) {
+                return false;
+            }
+
+            // exif (APP1) comes before the frame header
+            if (marker == 0xE1) {
+                std::vector<unsigned char> segment(static_cast<size_t>(length - 2));
+                if (!file.read(reinterpret_cast<char*>(segment.data()), static_cast<std::streamsize>(segment.size()))) {
+                    return false;
+                }
+                int orientation = exifOrientation(segment);
+                if (orientation != 1) {
+                    info.orientation = orientation;
+                }
+                continue;
+            }
+
+            // C4 (huffman tables), C8 (reserved) and CC (arithmetic conditioning) share the range
+            bool frame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+            if (frame) {
+                unsigned char header[6];
+                if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+                    return false;
+                }
+                int height = (header[1] << 8) | header[2];
+                int width = (header[3] << 8) | header[4];
+                if (width <= 0 || height <= 0) {
+                    return false;
+                }
+                info.size = cv::Size(width, height);
+                info.precision = header[0];
+                info.components = header[5];
+                return true;
+            }
+            file.seekg(length - 2, std::ios::cur);
+        }
+        return false;
+    }
+
+    // true if a png holds 8-bit rgb without exif, which a color decode keeps as it is
+    bool pngDecodesUnchanged(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        unsigned char head[8];
+        if (!file.read(reinterpret_cast<char*>(head), sizeof(head)) || !std::equal(signature, signature + 8, head)) {
+            return false;
+        }
+
+        // chunks: a big-endian length, the type, the data and a crc, up to the image data
+        for (bool first = true; file; first = false) {
+            unsigned char chunk[8];
+            if (!file.read(reinterpret_cast<char*>(chunk), sizeof(chunk))) {
+                return false;
+            }
+            uint32_t length = (uint32_t(chunk[0]) << 24) | (chunk[1] << 16) | (chunk[2] << 8) | chunk[3];
+            std::string type(reinterpret_cast<char*>(chunk) + 4, 4);
+            if (first) {
+                unsigned char header[13];
+                if (type != "IHDR" || length != sizeof(header)
+                    || !file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+                    return false;
+                }
+                // bit depth 8, color type 2 (truecolor without alpha)
+                if (header[8] != 8 || header[9] != 2) {
+                    return false;
+                }
+                file.seekg(4, std::ios::cur);
+                continue;
+            }
+            if (type == "IDAT") {
+                return true;
+            }
+            if (type == "eXIf") {
+                return false;
+            }
+            file.seekg(static_cast<std::streamoff>(length) + 4, std::ios::cur);
+        }
+        return false;
+    }
+}
+
+bool ImageLoader::readJpegSize(const std::string& path, cv::Size& size) {
+    JpegInfo info;
+    if (!readJpegInfo(path, info)) {
+        return false;
+    }
+    size = info.size;
+    return true;
+}
+
+DecodePlan ImageLoader::planDecode(const PipelineConfig& config, cv::Size source_size) {
+    DecodePlan plan;
+    plan.config = config;
+    plan.source_size = source_size;
+    plan.decoded_size = source_size;
+
+    // roi coordinates refer to the full-resolution frame
+    if (!config.global_roi.full_image) {
+        return plan;
+    }
+
+    // an optional leading crop, then the resize that makes full resolution unnecessary
+    const auto& ops = config.operations;
+    cv::Rect region(0, 0, source_size.width, source_size.height);
+    size_t next = 0;
+    if (!ops.empty() && ops[0].type == "crop") {
+        if (!ops[0].roi.full_image || !PipelineOptimizer::resolveCrop(ops[0], source_size, region)) {
+            return plan;
+        }
+        next = 1;
+    }
+    if (next >= ops.size() || ops[next].type != "resize") {
+        return plan;
+    }
+
+    // largest reduction that still leaves the resize shrinking
+    cv::Size target = ResizeOperation::targetSize(ops[next].parameters, region.size());
+    for (int reduction : {8, 4, 2}) {
+        if (region.width >= reduction * target.width && region.height >= reduction * target.height) {
+            plan.reduction = reduction;
+            break;
+        }
+    }
+    if (plan.reduction == 1) {
+        return plan;
+    }
+
+    // the decoder rounds scaled dimensions up
+    const int k = plan.reduction;
+    plan.flags = reducedFlags(k);
+    plan.decoded_size = cv::Size((source_size.width + k - 1) / k, (source_size.height + k - 1) / k);
+
+    std::vector<OperationConfig> rewritten;
+    if (next == 1) {
+        // the crop at the decoded scale, rounded outwards
+        int x = region.x / k;
+        int y = region.y / k;
+        int right = std::min((region.x + region.width + k - 1) / k, plan.decoded_size.width);
+        int bottom = std::min((region.y + region.height + k - 1) / k, plan.decoded_size.height);
+
+        OperationConfig crop = ops[0];
+        crop.parameters = {{"x", x}, {"y", y}, {"width", right - x}, {"height", bottom - y}};
+        rewritten.push_back(crop);
+    }
+
+    // the resize finishes at the exact size the full-resolution pipeline would produce
+    OperationConfig resize = ops[next];
+    resize.parameters = {{"width", target.width}, {"height", target.height}};
+    rewritten.push_back(resize);
+
+    rewritten.insert(rewritten.end(), ops.begin() + next + 1, ops.end());
+    plan.config.operations = rewritten;
+    return plan;
+}
+
+DecodePlan ImageLoader::load(const std::string& path, const PipelineConfig& config, bool fast_decode, cv::Mat& image) {
+    DecodePlan plan;
+    plan.config = config;
+
+    // the decoder turns an exif-oriented image after scaling it, which moves the partial blocks
+    // at the far edges to the near ones, so a rewritten crop would no longer line up
+    JpegInfo info;
+    if (fast_decode && readJpegInfo(path, info) && info.orientation == 1) {
+        plan = planDecode(config, info.size);
+    }
+
+    if (plan.reduction > 1) {
+        cv::imread(path, image, plan.flags);
+        if (!image.empty() && image.size() == plan.decoded_size) {
+            return plan;
+        }
+
+        // the decoder applied an exif rotation (or disagreed otherwise): decode normally
+        plan = DecodePlan();
+        plan.config = config;
+    }
+
+    read(path, image, plan.flags);
+    plan.source_size = image.size();
+    plan.decoded_size = image.size();
+    return plan;
+}
+
+void ImageLoader::read(const std::string& path, cv::Mat& image, int flags) {
+    if (RawImageFile::isRawPath(path)) {
+        image = RawImageFile::map(path);
+        return;
+    }
+    cv::imread(path, image, flags);
+}
+
+bool ImageLoader::save(const std::string& path, const cv::Mat& image, const std::vector<int>& params) {
+    if (RawImageFile::isRawPath(path)) {
+        return RawImageFile::write(path, image);
+    }
+    return cv::imwrite(path, image, params);
+}
+
+bool ImageLoader::copyUnchanged(const std::string& path, const std::string& output_path, const std::vector<int>& params) {
+    auto extension = [](const std::string& file) {
+        std::string value = fs::path(file).extension().string();
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    };
+    if (!params.empty() || extension(path).empty() || extension(path) != extension(output_path)
+        || RawImageFile::isRawPath(path)) {
+        return false;
+    }
+
+    // only files whose color decode would keep them as they are, so the output does not
+    // depend on the copy being taken
+    std::error_code error;
+    if (!fs::is_regular_file(path, error) || !decodesUnchanged(path)) {
+        return false;
+    }
+    if (fs::exists(output_path, error) && fs::equivalent(path, output_path, error)) {
+        return true;
+    }
+    return fs::copy_file(path, output_path, fs::copy_options::overwrite_existing, error);
+}
+
+bool ImageLoader::decodesUnchanged(const std::string& path) {
+    JpegInfo info;
+    if (readJpegInfo(path, info)) {
+        return info.precision == 8 && info.components == 3 && info.orientation == 1;
+    }
+    return pngDecodesUnchanged(path);
+}
+
+int ImageLoader::reducedFlags(int reduction) {
+    switch (reduction) {
+        case 2:
+            return cv::IMREAD_REDUCED_COLOR_2;
+        case 4:
+            return cv::IMREAD_REDUCED_COLOR_4;
+        case 8:
+            return cv::IMREAD_REDUCED_COLOR_8;
+        default:
+            return cv::IMREAD_COLOR;
+    }
+}
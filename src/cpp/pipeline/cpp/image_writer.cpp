@@ -0,0 +1,77 @@
+#include "../hpp/image_writer.hpp"
+#include "../hpp/image_loader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+std::vector<int> EncodeOptions::params() const {
+    std::vector<int> values;
+    if (jpeg_quality >= 0) {
+        values.insert(values.end(), {cv::IMWRITE_JPEG_QUALITY, jpeg_quality});
+    }
+    if (png_compression >= 0) {
+        values.insert(values.end(), {cv::IMWRITE_PNG_COMPRESSION, png_compression});
+    }
+    if (webp_quality >= 0) {
+        values.insert(values.end(), {cv::IMWRITE_WEBP_QUALITY, webp_quality});
+    }
+    return values;
+}
+
+ImageWriter::ImageWriter(size_t workers, size_t queue_capacity, const EncodeOptions& options)
+    : params(options.params()), queue(queue_capacity) {
+    workers = std::max<size_t>(1, workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([this] { work(); });
+    }
+}
+
+ImageWriter::~ImageWriter() {
+    finish();
+}
+
+bool ImageWriter::submit(const std::string& path, const cv::Mat& image, std::function<void()> written) {
+    return queue.push({path, image, std::move(written)});
+}
+
+WriterStats ImageWriter::finish() {
+    queue.close();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.submit_wait_seconds = queue.pushWaitSeconds();
+    return stats;
+}
+
+void ImageWriter::work() {
+    Job job;
+    while (queue.pop(job)) {
+        auto start = std::chrono::steady_clock::now();
+        bool written = false;
+        try {
+            written = ImageLoader::save(job.path, job.image, params);
+            if (!written) {
+                std::cerr << "error: could not save image to '" << job.path << "'" << std::endl;
+            } else if (job.written) {
+                job.written();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "error: " << job.path << ": " << e.what() << std::endl;
+        }
+        // drop the image before waiting for the next one
+        job.image.release();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.busy_seconds += seconds;
+        if (written) {
+            ++stats.written;
+        } else {
+            ++stats.failed;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#include "../hpp/pipeline_compiler.hpp"
+#include "../../bindings/hpp/operation_factory.hpp"
+#include "../../operations/hpp/fused_operation.hpp"
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+CompiledPipeline PipelineCompiler::compile(const PipelineConfig& config, bool fuse_pointwise) {
+    std::vector<CompiledStep> steps;
+
+    for (const auto& op_config : config.operations) {
+        // create operation using factory
+        auto operation = OperationFactory::createOperation(op_config.type);
+        if (!operation) {
+            throw std::runtime_error("could not create operation of type '" + op_config.type + "'");
+        }
+
+        ROI roi = resolveROI(config, op_config);
+        steps.push_back({op_config.type, std::move(operation), op_config.parameters, roi,
+                         signature(op_config.type, op_config.parameters, roi)});
+    }
+
+    CompiledPipeline pipeline;
+    pipeline.steps = fuse_pointwise ? fusePointwise(std::move(steps)) : std::move(steps);
+
+    // validate once and precompute tables, so running the plan only does pixel work
+    for (auto& step : pipeline.steps) {
+        step.operation->prepare(step.parameters);
+    }
+    return pipeline;
+}
+
+void PipelineCompiler::validate(const PipelineConfig& config) {
+    for (const auto& op_config : config.operations) {
+        auto operation = OperationFactory::createOperation(op_config.type);
+        if (!operation) {
+            throw std::runtime_error("could not create operation of type '" + op_config.type + "'");
+        }
+        if (!operation->validateParameters(op_config.parameters)) {
+            throw std::runtime_error("invalid parameters for operation: " + operation->getName());
+        }
+    }
+}
+
+ROI PipelineCompiler::resolveROI(const PipelineConfig& config, const OperationConfig& op_config) {
+    return op_config.roi.full_image ? config.global_roi : op_config.roi;
+}
+
+std::string PipelineCompiler::signature(const std::string& type, const std::map<std::string, double>& parameters, const ROI& roi) {
+    std::ostringstream out;
+    out << std::setprecision(17) << type;
+    for (const auto& [name, value] : parameters) {
+        out << " " << name << "=" << value;
+    }
+    if (!roi.full_image) {
+        out << " roi=" << roi.x << "," << roi.y << "," << roi.width << "x" << roi.height;
+    }
+    return out.str();
+}
+
+bool PipelineCompiler::sameROI(const ROI& a, const ROI& b) {
+    if (a.full_image || b.full_image) {
+        return a.full_image == b.full_image;
+    }
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+std::vector<CompiledStep> PipelineCompiler::fusePointwise(std::vector<CompiledStep> steps) {
+    std::vector<CompiledStep> fused_steps;
+
+    size_t i = 0;
+    while (i < steps.size()) {
+        // find the end of the pointwise run starting at i
+        size_t end = i;
+        while (end < steps.size()
+               && steps[end].operation->isPointwise()
+               && sameROI(steps[end].roi, steps[i].roi)) {
+            ++end;
+        }
+
+        // a run of one gains nothing from fusion
+        if (end - i < 2) {
+            fused_steps.push_back(std::move(steps[i]));
+            ++i;
+            continue;
+        }
+
+        auto fused = std::make_unique<FusedPointwiseOperation>();
+        std::string type;
+        std::string stages;
+        for (size_t j = i; j < end; ++j) {
+            type += (type.empty() ? "" : "+") + steps[j].type;
+            stages += (stages.empty() ? "" : " + ") + steps[j].signature;
+            fused->addStage(std::move(steps[j].operation), steps[j].parameters);
+        }
+
+        fused_steps.push_back({type, std::move(fused), {}, steps[i].roi, stages});
+        i = end;
+    }
+
+    return fused_steps;
+}
@@ -0,0 +1,295 @@
+#include "../hpp/pipeline_executor.hpp"
+#include "../hpp/region_planner.hpp"
+#include "../../runtime/hpp/scheduler.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+PipelineExecutor::PipelineExecutor(bool verbose)
+    : verbose(verbose) {}
+
+cv::Mat PipelineExecutor::run(const CompiledPipeline& pipeline, const cv::Mat& image) {
+    // pipeline-owned working copy, drawn from the pool instead of a fresh clone
+    cv::Mat working = pool.acquire(image.size(), image.type());
+    image.copyTo(working);
+    return runInPlace(pipeline, working);
+}
+
+cv::Mat PipelineExecutor::runInPlace(const CompiledPipeline& pipeline, cv::Mat& image) {
+    // steps draw their scratch and output buffers from this executor's pool
+    BufferPool::Scope scope(pool);
+
+    cv::Mat result = image;
+    image.release();
+
+    runSteps(pipeline, 0, pipeline.steps.size(), result);
+    return result;
+}
+
+cv::Mat PipelineExecutor::runMemoized(const CompiledPipeline& pipeline, const cv::Mat& image, uint64_t input_key,
+                                      StepCache& cache, size_t* reused) {
+    BufferPool::Scope scope(pool);
+
+    std::vector<uint64_t> keys(pipeline.steps.size());
+    uint64_t key = input_key;
+    for (size_t i = 0; i < pipeline.steps.size(); ++i) {
+        key = StepCache::extend(key, pipeline.steps[i].signature);
+        keys[i] = key;
+    }
+
+    // resume after the longest prefix already computed; results are not kept
+    size_t begin = pipeline.steps.empty() ? 0 : pipeline.steps.size() - 1;
+    cv::Mat start;
+    while (begin > 0 && !cache.find(keys[begin - 1], start)) {
+        --begin;
+    }
+    if (begin == 0) {
+        start = image;
+    }
+    if (verbose && begin > 0) {
+        std::cout << "  steps 1-" << begin << " reused from the step cache" << std::endl;
+    }
+
+    // the input and the prefixes this run resumes from stay ahead of deeper images
+    std::vector<uint64_t> chain{input_key};
+    chain.insert(chain.end(), keys.begin(), keys.begin() + begin);
+    cache.touch(chain);
+
+    // cached images are shared, so the steps work in a copy; steps run one at a time to
+    // keep every intermediate but the result, as a rerun that changes anything recomputes
+    // at least the last step
+    cv::Mat result = pool.acquire(start.size(), start.type());
+    start.copyTo(result);
+    for (size_t i = begin; i < pipeline.steps.size(); ++i) {
+        runSteps(pipeline, i, i + 1, result);
+        if (i + 1 < pipeline.steps.size()) {
+            cache.storeAfter(i == 0 ? input_key : keys[i - 1], keys[i], result);
+        }
+    }
+
+    if (reused) {
+        *reused = begin;
+    }
+    return result;
+}
+
+cv::Mat PipelineExecutor::runRegion(const CompiledPipeline& pipeline, const cv::Mat& image, const cv::Rect& region) {
+    BufferPool::Scope scope(pool);
+
+    // steps whose output geometry is only known once they ran go first, over everything
+    cv::Mat frame = image;
+    size_t begin = RegionPlanner::regionStart(pipeline);
+    if (begin > 0) {
+        frame = pool.acquire(image.size(), image.type());
+        image.copyTo(frame);
+        runSteps(pipeline, 0, begin, frame);
+    }
+
+    RegionPlan plan = RegionPlanner::plan(pipeline, begin, frame.size(), region);
+    if (verbose) {
+        std::cout << "  region " << plan.output.width << "x" << plan.output.height << " at " << plan.output.x << ","
+                  << plan.output.y << " computes " << plan.fraction * 100.0 << "% of the pixels of a full run" << std::endl;
+    }
+
+    // `block` holds the pixels of `area` in the current frame; like a padded tile, its
+    // edges may go stale inside the frame, but never within what later steps still need
+    cv::Rect area = plan.steps.empty() ? plan.output : plan.steps.front().required;
+    cv::Mat block = pool.acquire(area.size(), frame.type());
+    frame(area).copyTo(block);
+    if (begin > 0) {
+        pool.release(frame);
+    }
+
+    for (size_t k = 0; k < plan.steps.size(); ++k) {
+        const RegionStep& region_step = plan.steps[k];
+        const CompiledStep& step = pipeline.steps[begin + k];
+
+        if (region_step.mode == RegionStep::Mode::Remap) {
+            // the crop keeps a part of the block, nothing is computed
+            cv::Rect kept = area & region_step.crop;
+            block = block(kept - area.tl());
+            area = kept - region_step.crop.tl();
+            continue;
+        }
+
+        // filters must see the block's edge as the edge of the data, as on a whole frame
+        if (block.isSubmatrix()) {
+            cv::Mat whole = pool.acquire(block.size(), block.type());
+            block.copyTo(whole);
+            block = whole;
+        }
+
+        TraceRecorder::Scope trace_scope(trace, static_cast<int>(begin + k));
+        TraceRecorder* recorder = TraceRecorder::current();
+        TraceShape step_input(block);
+        TraceRecorder::Mark step_begin;
+        if (recorder) {
+            step_begin = TraceRecorder::mark();
+        }
+
+        runStep(step, block);
+
+        if (recorder) {
+            recorder->record(step.type + " (region)", "step", step_begin, step_input, block);
+        }
+        if (verbose) {
+            std::cout << "  step " << (begin + k + 1) << ": " << step.type << " on " << area.width << "x" << area.height << std::endl;
+        }
+    }
+
+    cv::Mat result = pool.acquire(plan.output.size(), block.type());
+    block(plan.output - area.tl()).copyTo(result);
+    pool.release(block);
+    return result;
+}
+
+void PipelineExecutor::runSteps(const CompiledPipeline& pipeline, size_t begin, size_t last, cv::Mat& result) {
+    size_t i = begin;
+    while (i < last) {
+        // chains of two or more whole-image steps on a multi-tile image run tiled
+        size_t end = (tile_size > 0) ? std::min(TilePlanner::tileableRunEnd(pipeline, i), last) : i;
+        bool tiled = end - i >= 2 && (result.cols > tile_size || result.rows > tile_size);
+        if (!tiled) {
+            end = i + 1;
+        }
+
+        if (verbose) {
+            for (size_t j = i; j < end; ++j) {
+                std::cout << "  step " << (j + 1) << ": " << pipeline.steps[j].type << (tiled ? " (tiled)" : "") << std::endl;
+            }
+        }
+
+        {
+            // operation phases inside the step are tagged with its index
+            TraceRecorder::Scope trace_scope(trace, static_cast<int>(i));
+            TraceRecorder* recorder = TraceRecorder::current();
+            TraceShape step_input(result);
+            TraceRecorder::Mark step_begin;
+            if (recorder) {
+                step_begin = TraceRecorder::mark();
+            }
+
+            if (tiled) {
+                runTiled(pipeline, i, end, result);
+            } else {
+                runStep(pipeline.steps[i], result);
+            }
+
+            if (recorder) {
+                std::string name = pipeline.steps[i].type;
+                for (size_t j = i + 1; j < end; ++j) {
+                    name += "+" + pipeline.steps[j].type;
+                }
+                recorder->record(tiled ? name + " (tiled)" : name, "step", step_begin, step_input, result);
+            }
+        }
+
+        if (verbose) {
+            for (size_t j = i; j < end; ++j) {
+                std::cout << "operation " << (j + 1) << " completed successfully!!" << std::endl;
+            }
+        }
+
+        i = end;
+    }
+}
+
+void PipelineExecutor::runStep(const CompiledStep& step, cv::Mat& image) {
+    // execute operation, writing into the pipeline-owned buffer when the operation allows it
+    if (step.operation->supportsInPlace()) {
+        step.operation->executeInPlace(image, step.roi, step.parameters);
+    } else {
+        // ping-pong: the previous buffer goes back to the pool once the step is done with it
+        cv::Mat previous = image;
+        image = step.operation->execute(previous, step.roi, step.parameters);
+        pool.release(previous);
+    }
+}
+
+void PipelineExecutor::runTiled(const CompiledPipeline& pipeline, size_t begin, size_t end, cv::Mat& image) {
+    // validate once up front so a bad parameter fails before any tile runs (compiled plans
+    // were validated when their operations were prepared)
+    for (size_t i = begin; i < end; ++i) {
+        const auto& step = pipeline.steps[i];
+        if (!step.operation->isPrepared() && !step.operation->validateParameters(step.parameters)) {
+            throw std::runtime_error("invalid parameters for operation: " + step.operation->getName());
+        }
+    }
+
+    int halo = TilePlanner::haloRadius(pipeline, begin, end);
+    std::vector<Tile> tiles = TilePlanner::planTiles(image.size(), tile_size, halo);
+
+    // tiles read halos from the input, so results go to a separate buffer
+    cv::Mat output = pool.acquire(image.size(), image.type());
+
+    // tiles run on opencv's workers, which need the caller's trace made current
+    TraceRecorder* recorder = TraceRecorder::current();
+
+    // tiles share the frame's slice of the thread budget; a frame worker without one runs them itself.
+    // each worker takes a contiguous share of the tiles and one tile buffer, kept for the next run
+    const int tile_count = static_cast<int>(tiles.size());
+    const int workers = std::max(1, std::min(Scheduler::shared().current().intra_threads, tile_count));
+    size_t largest = 0;
+    for (const Tile& tile : tiles) {
+        largest = std::max(largest, static_cast<size_t>(tile.padded.area()) * image.elemSize());
+    }
+    if (tile_buffers.size() < static_cast<size_t>(workers)) {
+        tile_buffers.resize(workers);
+    }
+    for (int w = 0; w < workers; ++w) {
+        if (tile_buffers[w].total() < largest) {
+            tile_buffers[w].create(1, static_cast<int>(largest), CV_8U);
+        }
+    }
+
+    auto runTiles = [&](const cv::Range& range) {
+        for (int w = range.start; w < range.end; ++w) {
+            for (int t = tile_count * w / workers; t < tile_count * (w + 1) / workers; ++t) {
+                const Tile& tile = tiles[t];
+
+                // isolated copy: filters must see the halo as the edge of the data,
+                // not reach into stale neighbours of the parent image
+                cv::Mat block(tile.padded.size(), image.type(), tile_buffers[w].data);
+                image(tile.padded).copyTo(block);
+                for (size_t i = begin; i < end; ++i) {
+                    const auto& step = pipeline.steps[i];
+                    TraceRecorder::Scope trace_scope(recorder, static_cast<int>(i), t);
+                    step.operation->executeInPlace(block, step.roi, step.parameters);
+                }
+
+                block(tile.core - tile.padded.tl()).copyTo(output(tile.core));
+                if (block.data != tile_buffers[w].data) {
+                    // a step that cannot write in place left its own buffer
+                    BufferPool::releaseScratch(block);
+                }
+            }
+        }
+    };
+
+    cv::Range all_workers(0, workers);
+    if (workers > 1) {
+        cv::parallel_for_(all_workers, runTiles, workers);
+    } else {
+        runTiles(all_workers);
+    }
+
+    pool.release(image);
+    image = output;
+}
+
+void PipelineExecutor::recycle(cv::Mat& buffer) {
+    pool.release(buffer);
+}
+
+BufferPool& PipelineExecutor::bufferPool() {
+    return pool;
+}
+
+void PipelineExecutor::setTileSize(int tile_size) {
+    this->tile_size = tile_size;
+}
+
+void PipelineExecutor::setTrace(TraceRecorder* trace) {
+    this->trace = trace;
+}
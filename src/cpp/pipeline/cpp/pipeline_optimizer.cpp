@@ -0,0 +1,393 @@
+#include "../hpp/pipeline_optimizer.hpp"
+#include "../../bindings/hpp/operation_factory.hpp"
+#include "../../operations/hpp/kernel_engine.hpp"
+#include "../../operations/hpp/lut_engine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+PipelineConfig PipelineOptimizer::optimize(const PipelineConfig& config, cv::Size input_size, const OptimizeOptions& options) {
+    // moved crops can leave steps they separated next to each other, so simplify once more
+    PipelineConfig optimized = pushDownCrops(simplify(config, input_size, options), input_size);
+    return simplify(optimized, input_size, options);
+}
+
+PipelineConfig PipelineOptimizer::simplify(const PipelineConfig& config, cv::Size input_size, const OptimizeOptions& options) {
+    PipelineConfig simplified = config;
+    auto& ops = simplified.operations;
+
+    // every rewrite removes a step, so this terminates
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t k = 0; k < ops.size() && !changed; ++k) {
+            cv::Size frame_size = input_size.empty() ? cv::Size() : frameSizeAt(simplified, k, input_size);
+            if (isIdentityStep(simplified, k, frame_size, options)) {
+                ops.erase(ops.begin() + k);
+                changed = true;
+                continue;
+            }
+            if (k + 1 == ops.size()) {
+                continue;
+            }
+
+            OperationConfig merged;
+            if ((options.depth == CV_8U && mergePointwise(simplified, ops[k], ops[k + 1], merged))
+                || mergeBlurs(simplified, ops[k], ops[k + 1], options.blur_tolerance, merged)) {
+                ops[k] = merged;
+                ops.erase(ops.begin() + k + 1);
+                changed = true;
+            }
+        }
+    }
+
+    return simplified;
+}
+
+bool PipelineOptimizer::isIdentity(const PipelineConfig& config) {
+    return simplify(config, cv::Size(), OptimizeOptions()).operations.empty();
+}
+
+PipelineConfig PipelineOptimizer::pushDownCrops(const PipelineConfig& config, cv::Size input_size) {
+    PipelineConfig optimized = config;
+    auto& ops = optimized.operations;
+
+    // each rewrite moves a crop strictly earlier, so this terminates; the cap is a safety net
+    bool changed = true;
+    for (size_t pass = 0; changed && pass < 4 * ops.size() + 4; ++pass) {
+        changed = false;
+
+        for (size_t k = 0; k < ops.size() && !changed; ++k) {
+            if (ops[k].type != "crop") {
+                continue;
+            }
+
+            cv::Size frame_size = frameSizeAt(optimized, k, input_size);
+            cv::Rect crop_rect;
+            if (!resolveCrop(ops[k], frame_size, crop_rect)) {
+                continue;
+            }
+
+            // two crops in a row are one crop
+            if (k > 0 && ops[k - 1].type == "crop") {
+                cv::Rect previous_rect;
+                if (resolveCrop(ops[k - 1], frameSizeAt(optimized, k - 1, input_size), previous_rect)) {
+                    cv::Rect merged(previous_rect.x + crop_rect.x, previous_rect.y + crop_rect.y,
+                                    crop_rect.width, crop_rect.height);
+                    ops[k - 1] = makeCrop(merged);
+                    ops.erase(ops.begin() + k);
+                    changed = true;
+                }
+                continue;
+            }
+
+            // walk back over the operations the crop can move in front of
+            size_t target = k;
+            int radius = 0;
+            while (target > 0 && canMoveCropBefore(optimized, ops[target - 1], radius)) {
+                --target;
+            }
+            if (target == k) {
+                continue;
+            }
+
+            // every filter passed can spoil `radius` pixels at the edge of the cropped
+            // frame, so crop that much wider (clipped to the frame, where the filters
+            // reflect exactly as before) and trim the margin afterwards
+            cv::Rect frame(0, 0, frame_size.width, frame_size.height);
+            cv::Rect expanded = cv::Rect(crop_rect.x - radius, crop_rect.y - radius,
+                                         crop_rect.width + 2 * radius, crop_rect.height + 2 * radius) & frame;
+            if (expanded == frame) {
+                continue;
+            }
+
+            std::vector<OperationConfig> rewritten(ops.begin(), ops.begin() + target);
+            rewritten.push_back(makeCrop(expanded));
+            rewritten.insert(rewritten.end(), ops.begin() + target, ops.begin() + k);
+            if (expanded != crop_rect) {
+                rewritten.push_back(makeCrop(crop_rect - expanded.tl()));
+            }
+            rewritten.insert(rewritten.end(), ops.begin() + k + 1, ops.end());
+
+            ops = std::move(rewritten);
+            changed = true;
+        }
+    }
+
+    return optimized;
+}
+
+std::string PipelineOptimizer::describe(const PipelineConfig& config) {
+    std::ostringstream out;
+
+    for (size_t i = 0; i < config.operations.size(); ++i) {
+        const auto& op = config.operations[i];
+        out << "  " << (i + 1) << ". " << op.type;
+        for (const auto& [key, value] : op.parameters) {
+            out << " " << key << "=" << value;
+        }
+        if (!op.roi.full_image) {
+            out << " roi=" << op.roi.x << "," << op.roi.y << "," << op.roi.width << "x" << op.roi.height;
+        }
+        out << "\n";
+    }
+
+    return out.str();
+}
+
+bool PipelineOptimizer::isIdentityStep(const PipelineConfig& config, size_t index, cv::Size frame_size, const OptimizeOptions& options) {
+    const auto& op = config.operations[index];
+
+    // crops and resizes ignore the roi and keep a frame of their own size as it is
+    if (op.type == "crop" || op.type == "resize") {
+        auto operation = OperationFactory::createOperation(op.type);
+        if (frame_size.empty() || !operation->validateParameters(op.parameters, false)) {
+            return false;
+        }
+        cv::Rect rect;
+        if (op.type == "crop") {
+            return resolveCrop(op, frame_size, rect) && rect.size() == frame_size;
+        }
+        return ResizeOperation::targetSize(op.parameters, frame_size) == frame_size;
+    }
+
+    // an roi that does not fit fails at run time, which dropping the step would hide
+    if (options.depth != CV_8U || !regionFits(regionOf(config, op), frame_size)) {
+        return false;
+    }
+    cv::Mat table = pointwiseTable(op);
+    if (table.empty()) {
+        return false;
+    }
+    const uchar* entries = table.ptr<uchar>();
+    for (int value = 0; value < 256; ++value) {
+        if (entries[value] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PipelineOptimizer::mergePointwise(const PipelineConfig& config, const OperationConfig& first,
+                                       const OperationConfig& second, OperationConfig& merged) {
+    auto affine = [](const OperationConfig& op) { return op.type == "brightness" || op.type == "contrast"; };
+    if (!affine(first) || !affine(second)) {
+        return false;
+    }
+
+    const ROI& region = regionOf(config, first);
+    const ROI& other = regionOf(config, second);
+    if (region.full_image != other.full_image
+        || (!region.full_image && cv::Rect(region.x, region.y, region.width, region.height)
+                                  != cv::Rect(other.x, other.y, other.width, other.height))) {
+        return false;
+    }
+
+    cv::Mat first_table = pointwiseTable(first);
+    cv::Mat second_table = pointwiseTable(second);
+    if (first_table.empty() || second_table.empty()) {
+        return false;
+    }
+
+    // both steps as v * factor + offset (same defaults as the operations)
+    auto param = [](const OperationConfig& op, const char* name, double fallback) {
+        auto it = op.parameters.find(name);
+        return it != op.parameters.end() ? it->second : fallback;
+    };
+    double factor1 = param(first, "factor", 1.0);
+    double offset1 = first.type == "contrast" ? param(first, "brightness_offset", 0.0) : 0.0;
+    double factor2 = param(second, "factor", 1.0);
+    double offset2 = second.type == "contrast" ? param(second, "brightness_offset", 0.0) : 0.0;
+
+    merged = OperationConfig();
+    merged.roi = first.roi;
+    merged.parameters["factor"] = factor1 * factor2;
+    if (first.type == "brightness" && second.type == "brightness") {
+        merged.type = "brightness";
+    } else {
+        merged.type = "contrast";
+        merged.parameters["brightness_offset"] = offset1 * factor2 + offset2;
+    }
+
+    // the algebra ignores the clamp and rounding after the first step, so the merged step is
+    // only kept when its table matches the two steps' composed table entry for entry
+    cv::Mat merged_table = pointwiseTable(merged);
+    return !merged_table.empty() && cv::countNonZero(merged_table != LutEngine::compose(first_table, second_table)) == 0;
+}
+
+bool PipelineOptimizer::mergeBlurs(const PipelineConfig& config, const OperationConfig& first,
+                                   const OperationConfig& second, double tolerance, OperationConfig& merged) {
+    if (tolerance <= 0.0 || first.type != "blur" || second.type != "blur") {
+        return false;
+    }
+
+    // a blur limited to an roi reads the pixels around it, so only whole-frame blurs compose
+    if (!regionOf(config, first).full_image || !regionOf(config, second).full_image) {
+        return false;
+    }
+    auto operation = OperationFactory::createOperation("blur");
+    if (!operation->validateParameters(first.parameters, false) || !operation->validateParameters(second.parameters, false)) {
+        return false;
+    }
+
+    // kernel sizes as bound by the operation (made odd), sigma with its default
+    auto sigmaOf = [](const OperationConfig& op) {
+        auto it = op.parameters.find("sigma");
+        return it != op.parameters.end() ? it->second : 1.0;
+    };
+    int size1 = 2 * operation->footprint(first.parameters).radius + 1;
+    int size2 = 2 * operation->footprint(second.parameters).radius + 1;
+    double sigma1 = sigmaOf(first);
+    double sigma2 = sigmaOf(second);
+
+    // the tolerance is in 8-bit levels, so compare the fixed-point taps 8-bit blurs really use;
+    // the two blurs are one separable filter whose taps are their kernels convolved
+    auto tapsOf = [](int size, double sigma) {
+        std::vector<double> taps;
+        for (int value : KernelEngine::getGaussian(size, sigma, CV_8U)->fixed) {
+            taps.push_back(value / 256.0);
+        }
+        return taps;
+    };
+    const int length = size1 + size2 - 1;
+    std::vector<double> kernel1 = tapsOf(size1, sigma1);
+    std::vector<double> kernel2 = tapsOf(size2, sigma2);
+    std::vector<double> composed(length, 0.0);
+    for (int i = 0; i < size1; ++i) {
+        for (int j = 0; j < size2; ++j) {
+            composed[i + j] += kernel1[i] * kernel2[j];
+        }
+    }
+
+    // gaussians compose by adding variances; take the smallest kernel that stays within the
+    // tolerance. both sets of 2d weights sum to one, so before rounding the merged blur differs
+    // by at most 255 times half their summed difference, plus half a level from rounding the
+    // first blur's output; rounding both results can then add one more level
+    const double sigma = std::sqrt(sigma1 * sigma1 + sigma2 * sigma2);
+    for (int size = 3; size <= std::min(length, 31); size += 2) {
+        merged = OperationConfig();
+        merged.type = "blur";
+        merged.roi = first.roi;
+        merged.parameters["kernel_size"] = size;
+        merged.parameters["sigma"] = sigma;
+        if (!operation->validateParameters(merged.parameters, false)) {
+            return false;
+        }
+
+        std::vector<double> single = tapsOf(size, sigma);
+        std::vector<double> replacement(length, 0.0);
+        for (int i = 0; i < size; ++i) {
+            replacement[(length - size) / 2 + i] = single[i];
+        }
+
+        double difference = 0.0;
+        for (int y = 0; y < length; ++y) {
+            for (int x = 0; x < length; ++x) {
+                difference += std::abs(composed[y] * composed[x] - replacement[y] * replacement[x]);
+            }
+        }
+        if (std::floor(127.5 * difference + 0.5) + 1.0 <= tolerance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+cv::Mat PipelineOptimizer::pointwiseTable(const OperationConfig& op) {
+    auto operation = OperationFactory::createOperation(op.type);
+    if (!operation || !operation->isPointwise() || !operation->validateParameters(op.parameters, false)) {
+        return cv::Mat();
+    }
+    return operation->lookupTable(op.parameters);
+}
+
+const ROI& PipelineOptimizer::regionOf(const PipelineConfig& config, const OperationConfig& op) {
+    return op.roi.full_image ? config.global_roi : op.roi;
+}
+
+bool PipelineOptimizer::regionFits(const ROI& roi, cv::Size frame_size) {
+    if (roi.full_image) {
+        return true;
+    }
+    cv::Rect rect(roi.x, roi.y, roi.width, roi.height);
+    return !frame_size.empty() && !rect.empty()
+           && (rect & cv::Rect(0, 0, frame_size.width, frame_size.height)) == rect;
+}
+
+bool PipelineOptimizer::canMoveCropBefore(const PipelineConfig& config, const OperationConfig& op, int& radius) {
+    // roi coordinates refer to the uncropped frame
+    if (!op.roi.full_image || !config.global_roi.full_image) {
+        return false;
+    }
+
+    auto operation = OperationFactory::createOperation(op.type);
+    if (!operation) {
+        return false;
+    }
+
+    Footprint footprint = operation->footprint(op.parameters);
+    switch (footprint.kind) {
+        case Footprint::Kind::Pointwise:
+            return true;
+        case Footprint::Kind::Neighbourhood:
+            radius += footprint.radius;
+            return true;
+        default:
+            return false;
+    }
+}
+
+cv::Size PipelineOptimizer::outputSize(const PipelineConfig& config, cv::Size input_size) {
+    return frameSizeAt(config, config.operations.size(), input_size);
+}
+
+bool PipelineOptimizer::resolveCrop(const OperationConfig& op, cv::Size frame_size, cv::Rect& rect) {
+    // same defaults as CropOperation::executeImpl
+    auto param = [&op](const char* name, double fallback) {
+        auto it = op.parameters.find(name);
+        return it != op.parameters.end() ? it->second : fallback;
+    };
+
+    int x = static_cast<int>(param("x", 0));
+    int y = static_cast<int>(param("y", 0));
+    int width = static_cast<int>(param("width", frame_size.width - x));
+    int height = static_cast<int>(param("height", frame_size.height - y));
+
+    // leave crops that would fail (and report it) where they are
+    if (x < 0 || y < 0 || x >= frame_size.width || y >= frame_size.height) {
+        return false;
+    }
+    if (width <= 0 || height <= 0 || x + width > frame_size.width || y + height > frame_size.height) {
+        return false;
+    }
+
+    rect = cv::Rect(x, y, width, height);
+    return true;
+}
+
+cv::Size PipelineOptimizer::frameSizeAt(const PipelineConfig& config, size_t index, cv::Size input_size) {
+    // only crops and resizes change the geometry
+    cv::Size size = input_size;
+    for (size_t i = 0; i < index; ++i) {
+        const auto& op = config.operations[i];
+        cv::Rect rect;
+        if (op.type == "crop" && resolveCrop(op, size, rect)) {
+            size = rect.size();
+        } else if (op.type == "resize") {
+            size = ResizeOperation::targetSize(op.parameters, size);
+        }
+    }
+    return size;
+}
+
+OperationConfig PipelineOptimizer::makeCrop(const cv::Rect& rect) {
+    OperationConfig op;
+    op.type = "crop";
+    op.parameters["x"] = rect.x;
+    op.parameters["y"] = rect.y;
+    op.parameters["width"] = rect.width;
+    op.parameters["height"] = rect.height;
+    op.roi = ROI(0, 0, 0, 0, true);
+    return op;
+}
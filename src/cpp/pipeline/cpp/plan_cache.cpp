@@ -0,0 +1,99 @@
+#include "../hpp/plan_cache.hpp"
+#include "../hpp/pipeline_optimizer.hpp"
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "../../runtime/hpp/content_hash.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+PlanCache::PlanCache(size_t capacity, bool optimize, double blur_tolerance)
+    : capacity(capacity == 0 ? 1 : capacity), optimize(optimize), blur_tolerance(blur_tolerance) {}
+
+std::shared_ptr<const CompiledPipeline> PlanCache::get(const std::string& pipeline_text, cv::Size input_size, int depth,
+                                                       bool* hit) {
+    // without the optimizer the plan does not depend on the size or depth
+    cv::Size size = optimize ? input_size : cv::Size();
+    depth = optimize ? depth : CV_8U;
+    uint64_t key = ContentHash::fnv1a(pipeline_text)
+                   ^ ((uint64_t(uint32_t(size.width)) << 32 | uint32_t(size.height)) + uint64_t(depth)) * 0x9e3779b97f4a7c15ULL;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end() && it->second->size == size && it->second->depth == depth
+            && it->second->text == pipeline_text) {
+            entries.splice(entries.begin(), entries, it->second);
+            ++hit_count;
+            if (hit) {
+                *hit = true;
+            }
+            return entries.front().plan;
+        }
+        ++miss_count;
+    }
+    if (hit) {
+        *hit = false;
+    }
+
+    // compile outside the lock; two threads missing on the same pipeline both compile, one plan is kept
+    std::shared_ptr<const CompiledPipeline> plan = build(pipeline_text, size, depth);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front({key, pipeline_text, size, depth, plan});
+    index[key] = entries.begin();
+
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    return plan;
+}
+
+std::shared_ptr<const CompiledPipeline> PlanCache::getFile(const std::string& path, cv::Size input_size, int depth,
+                                                           bool* hit) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("could not open pipeline file: " + path);
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return get(text.str(), input_size, depth, hit);
+}
+
+size_t PlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t PlanCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+size_t PlanCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
+
+std::shared_ptr<const CompiledPipeline> PlanCache::build(const std::string& pipeline_text, cv::Size input_size, int depth) const {
+    nlohmann::json pipeline_json;
+    try {
+        pipeline_json = nlohmann::json::parse(pipeline_text);
+    } catch (const nlohmann::json::parse_error& e) {
+        throw std::runtime_error("invalid JSON in pipeline: " + std::string(e.what()));
+    }
+
+    PipelineConfig config = PipelineReader::parsePipeline(pipeline_json);
+    if (optimize) {
+        OptimizeOptions rewrite;
+        rewrite.depth = depth;
+        rewrite.blur_tolerance = blur_tolerance;
+        config = PipelineOptimizer::optimize(config, input_size, rewrite);
+    }
+    return std::make_shared<const CompiledPipeline>(PipelineCompiler::compile(config));
+}
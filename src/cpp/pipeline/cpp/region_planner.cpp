@@ -0,0 +1,92 @@
+#include "../hpp/region_planner.hpp"
+#include "../hpp/pipeline_optimizer.hpp"
+#include <stdexcept>
+
+size_t RegionPlanner::regionStart(const CompiledPipeline& pipeline) {
+    // crops are the only geometry the planner can follow
+    size_t begin = 0;
+    for (size_t i = 0; i < pipeline.steps.size(); ++i) {
+        const auto& step = pipeline.steps[i];
+        bool geometry = step.operation->footprint(step.parameters).kind == Footprint::Kind::Geometry;
+        if (geometry && !(step.type == "crop" && step.roi.full_image)) {
+            begin = i + 1;
+        }
+    }
+    return begin;
+}
+
+RegionPlan RegionPlanner::plan(const CompiledPipeline& pipeline, size_t begin, cv::Size input_size, const cv::Rect& region) {
+    RegionPlan plan;
+    plan.begin = begin;
+
+    // forward: the frame each step sees
+    std::vector<cv::Rect> frames = {cv::Rect(0, 0, input_size.width, input_size.height)};
+    for (size_t i = begin; i < pipeline.steps.size(); ++i) {
+        RegionStep step;
+        step.mode = modeOf(pipeline.steps[i], frames.back().size(), step.crop);
+        frames.push_back(step.mode == RegionStep::Mode::Remap ? cv::Rect(cv::Point(), step.crop.size()) : frames.back());
+        plan.steps.push_back(step);
+    }
+
+    plan.output = region & frames.back();
+    if (plan.output.empty()) {
+        throw std::runtime_error("requested region lies outside the output image");
+    }
+
+    // backward: each step needs its output region widened by its footprint; at the frame
+    // edge the widened region is clipped, where filters reflect exactly as on the whole frame
+    cv::Rect needed = plan.output;
+    for (size_t k = plan.steps.size(); k-- > 0;) {
+        RegionStep& step = plan.steps[k];
+        const CompiledStep& compiled = pipeline.steps[begin + k];
+        switch (step.mode) {
+            case RegionStep::Mode::Region: {
+                int radius = compiled.operation->footprint(compiled.parameters).radius;
+                step.required = cv::Rect(needed.x - radius, needed.y - radius,
+                                         needed.width + 2 * radius, needed.height + 2 * radius) & frames[k];
+                break;
+            }
+            case RegionStep::Mode::Remap:
+                step.required = needed + step.crop.tl();
+                break;
+            case RegionStep::Mode::Whole:
+                step.required = frames[k];
+                break;
+        }
+        needed = step.required;
+    }
+
+    // forward again, as the executor runs it: every computing step processes the block the
+    // first step needs, only crops narrow it
+    cv::Rect area = plan.steps.empty() ? plan.output : plan.steps.front().required;
+    double computed = 0.0;
+    double full = 0.0;
+    for (size_t k = 0; k < plan.steps.size(); ++k) {
+        const RegionStep& step = plan.steps[k];
+        if (step.mode == RegionStep::Mode::Remap) {
+            area = (area & step.crop) - step.crop.tl();
+            continue;
+        }
+        computed += area.area();
+        full += frames[k].area();
+    }
+
+    plan.fraction = full > 0.0 ? computed / full : 1.0;
+    return plan;
+}
+
+RegionStep::Mode RegionPlanner::modeOf(const CompiledStep& step, cv::Size frame_size, cv::Rect& crop) {
+    if (!step.roi.full_image) {
+        return RegionStep::Mode::Whole;
+    }
+    if (step.operation->footprint(step.parameters).kind != Footprint::Kind::Geometry) {
+        return RegionStep::Mode::Region;
+    }
+
+    // a crop that would fail leaves the frame as it is, so it simply runs on all of it
+    OperationConfig op;
+    op.type = step.type;
+    op.parameters = step.parameters;
+    op.roi = step.roi;
+    return PipelineOptimizer::resolveCrop(op, frame_size, crop) ? RegionStep::Mode::Remap : RegionStep::Mode::Whole;
+}
@@ -0,0 +1,269 @@
+#include "../hpp/result_cache.hpp"
+#include "../hpp/pipeline_compiler.hpp"
+#include "../../runtime/hpp/content_hash.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string lowercaseExtension(const std::string& path) {
+        std::string extension = fs::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+
+    // entry names are 64 hex digits (a sha-256) and the output's extension, if any
+    bool isEntryName(const std::string& name) {
+        const size_t digits = 64;
+        if (name.size() < digits || name.size() == digits + 1) {
+            return false;
+        }
+        for (size_t i = 0; i < name.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(name[i]);
+            bool valid = i < digits ? std::isdigit(c) || (c >= 'a' && c <= 'f') : i == digits ? c == '.' : std::isalnum(c);
+            if (!valid) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // store writes ".<entry name>-<unique>" and renames it into place
+    bool isTemporaryName(const std::string& name) {
+        size_t dash = name.find('-');
+        return name.size() > 1 && name[0] == '.' && dash != std::string::npos && isEntryName(name.substr(1, dash - 1));
+    }
+
+    // how often a process looks at what others put in a shared directory
+    const auto rescan_interval = std::chrono::seconds(10);
+
+    // a temporary file this old belongs to a run that stopped before renaming it
+    const auto stale_age = std::chrono::hours(1);
+}
+
+ResultCache::ResultCache(const std::string& directory, uint64_t max_bytes, bool fast_keys)
+    : directory(directory), max_bytes(max_bytes), fast_keys(fast_keys) {
+    fs::create_directories(directory);
+    rescan();
+}
+
+std::string ResultCache::describe(const PipelineConfig& config, bool fast_decode, double blur_tolerance,
+                                  const std::vector<int>& encode_params) {
+    std::ostringstream out;
+    for (const auto& op : config.operations) {
+        out << PipelineCompiler::signature(op.type, op.parameters, PipelineCompiler::resolveROI(config, op)) << ";";
+    }
+    out << std::setprecision(17) << "|fast_decode=" << fast_decode << " blur_tolerance=" << blur_tolerance << " encode=";
+    for (int value : encode_params) {
+        out << value << ",";
+    }
+    return out.str();
+}
+
+std::string ResultCache::key(const std::string& input_path, const std::string& output_path, const std::string& pipeline) const {
+    std::error_code error;
+    std::string input;
+    if (fast_keys) {
+        // trusts that a file with the same path, size and time has the same contents
+        uint64_t size = fs::file_size(input_path, error);
+        if (error) {
+            return std::string();
+        }
+        auto time = fs::last_write_time(input_path, error);
+        if (error) {
+            return std::string();
+        }
+        input = fs::absolute(input_path, error).lexically_normal().string() + "|" + std::to_string(size) + "|"
+                + std::to_string(time.time_since_epoch().count());
+    } else {
+        std::ifstream file(input_path, std::ios::binary);
+        if (!file.is_open()) {
+            return std::string();
+        }
+        ContentHash::Sha256 hash;
+        std::vector<char> chunk(1 << 20);
+        while (file) {
+            file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            hash.update(chunk.data(), static_cast<size_t>(file.gcount()));
+        }
+        if (file.bad()) {
+            return std::string();
+        }
+        input = hash.hexDigest();
+    }
+
+    // nothing but the digest is kept, so it covers everything that tells outputs apart
+    return ContentHash::sha256(input + "\n" + lowercaseExtension(output_path) + "\n" + pipeline);
+}
+
+bool ResultCache::fetch(const std::string& key, const std::string& output_path) {
+    if (key.empty()) {
+        return false;
+    }
+    std::string name = entryName(key, output_path);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(name);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+        }
+    }
+
+    // copy outside the lock, whether indexed or not: another process may have stored the
+    // entry since the last scan, or evicted it meanwhile (as may this one)
+    std::error_code error;
+    fs::path stored = fs::path(directory) / name;
+    if (!fs::copy_file(stored, output_path, fs::copy_options::overwrite_existing, error)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(name);
+        if (it != index.end()) {
+            total_bytes -= it->second->bytes;
+            entries.erase(it->second);
+            index.erase(it);
+        }
+        ++miss_count;
+        return false;
+    }
+
+    // the modification time records use, so a later run starts from the same order
+    fs::last_write_time(stored, fs::file_time_type::clock::now(), error);
+    uint64_t size = fs::file_size(output_path, error);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error && index.find(name) == index.end()) {
+        entries.push_front({name, size});
+        index[name] = entries.begin();
+        total_bytes += size;
+        evict();
+    }
+    ++hit_count;
+    return true;
+}
+
+void ResultCache::store(const std::string& key, const std::string& output_path) {
+    if (key.empty()) {
+        return;
+    }
+    std::string name = entryName(key, output_path);
+
+    // copy under a private name, then rename: readers see the whole file or none
+    static std::atomic<uint64_t> sequence{0};
+    std::string unique = ContentHash::hex(std::hash<std::thread::id>()(std::this_thread::get_id())
+                             ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()))
+                         + "-" + std::to_string(sequence++);
+    fs::path temporary = fs::path(directory) / ("." + name + "-" + unique);
+    fs::path stored = fs::path(directory) / name;
+
+    std::error_code error;
+    if (!fs::copy_file(output_path, temporary, fs::copy_options::overwrite_existing, error)) {
+        return;
+    }
+    uint64_t size = fs::file_size(temporary, error);
+    if (!error) {
+        fs::rename(temporary, stored, error);
+    }
+    if (error) {
+        fs::remove(temporary, error);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = index.find(name);
+    if (it != index.end()) {
+        total_bytes -= it->second->bytes;
+        entries.erase(it->second);
+    }
+    entries.push_front({name, size});
+    index[name] = entries.begin();
+    total_bytes += size;
+
+    // now and then count what other processes sharing the directory have added
+    auto now = std::chrono::steady_clock::now();
+    if (now - scanned < rescan_interval) {
+        evict();
+        return;
+    }
+    scanned = now;
+    lock.unlock();
+    rescan();
+}
+
+size_t ResultCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+size_t ResultCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
+
+uint64_t ResultCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total_bytes;
+}
+
+void ResultCache::rescan() {
+    // entries on disk, most recently used (written or hit) first
+    std::vector<std::tuple<fs::file_time_type, std::string, uint64_t>> found;
+    auto stale = fs::file_time_type::clock::now() - stale_age;
+    std::error_code error;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        std::string name = it->path().filename().string();
+        std::error_code file_error;
+        if (!it->is_regular_file(file_error)) {
+            continue;
+        }
+        uint64_t size = it->file_size(file_error);
+        fs::file_time_type time = it->last_write_time(file_error);
+        if (file_error) {
+            continue;
+        }
+        if (isEntryName(name)) {
+            found.emplace_back(time, name, size);
+        } else if (isTemporaryName(name) && time < stale) {
+            fs::remove(it->path(), file_error);
+        }
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    total_bytes = 0;
+    for (const auto& [time, name, size] : found) {
+        entries.push_back({name, size});
+        index[name] = std::prev(entries.end());
+        total_bytes += size;
+    }
+    scanned = std::chrono::steady_clock::now();
+    evict();
+}
+
+void ResultCache::evict() {
+    while (total_bytes > max_bytes && !entries.empty()) {
+        const Entry& oldest = entries.back();
+        std::error_code error;
+        fs::remove(fs::path(directory) / oldest.name, error);
+        total_bytes -= oldest.bytes;
+        index.erase(oldest.name);
+        entries.pop_back();
+    }
+}
+
+std::string ResultCache::entryName(const std::string& key, const std::string& output_path) {
+    return key + lowercaseExtension(output_path);
+}
@@ -0,0 +1,96 @@
+#include "../hpp/step_cache.hpp"
+#include "../../runtime/hpp/content_hash.hpp"
+
+StepCache::StepCache(size_t max_bytes)
+    : max_bytes(max_bytes) {}
+
+uint64_t StepCache::extend(uint64_t key, const std::string& step) {
+    // the separator keeps "a" + "bc" apart from "ab" + "c"
+    return ContentHash::fnv1a("\n", 1, ContentHash::fnv1a(step, key));
+}
+
+bool StepCache::find(uint64_t key, cv::Mat& image) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        ++miss_count;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    image = it->second->image;
+    ++hit_count;
+    return true;
+}
+
+void StepCache::store(uint64_t key, const cv::Mat& image) {
+    // copied outside the lock, the caller keeps writing into its own image
+    Entry entry{key, image.clone(), image.total() * image.elemSize()};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(std::move(entry));
+}
+
+void StepCache::storeAfter(uint64_t parent, uint64_t key, const cv::Mat& image) {
+    Entry entry{key, image.clone(), image.total() * image.elemSize()};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(std::move(entry), &parent);
+}
+
+void StepCache::adopt(uint64_t key, const cv::Mat& image) {
+    std::lock_guard<std::mutex> lock(mutex);
+    insert({key, image, image.total() * image.elemSize()});
+}
+
+void StepCache::touch(const std::vector<uint64_t>& chain) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto key = chain.rbegin(); key != chain.rend(); ++key) {
+        auto it = index.find(*key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+        }
+    }
+}
+
+void StepCache::insert(Entry entry, const uint64_t* parent) {
+    uint64_t key = entry.key;
+    auto it = index.find(key);
+    if (it != index.end()) {
+        total_bytes -= it->second->bytes;
+        entries.erase(it->second);
+    }
+    // behind its parent; an image whose parent was already evicted goes first out
+    auto position = entries.begin();
+    if (parent) {
+        auto found = index.find(*parent);
+        position = found != index.end() ? std::next(found->second) : entries.end();
+    }
+    total_bytes += entry.bytes;
+    index[key] = entries.insert(position, std::move(entry));
+
+    while (total_bytes > max_bytes && !entries.empty()) {
+        total_bytes -= entries.back().bytes;
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+size_t StepCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t StepCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total_bytes;
+}
+
+size_t StepCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+size_t StepCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
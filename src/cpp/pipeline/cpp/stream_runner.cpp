@@ -0,0 +1,290 @@
+#include "../hpp/stream_runner.hpp"
+#include "../hpp/pipeline_compiler.hpp"
+#include "../hpp/pipeline_executor.hpp"
+#include "../hpp/pipeline_optimizer.hpp"
+#include "../../runtime/hpp/bounded_queue.hpp"
+#include "../../runtime/hpp/scheduler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    // one frame travelling between stages
+    struct StreamFrame {
+        size_t index = 0;
+        cv::Mat image;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+StreamResult StreamRunner::run(const PipelineConfig& config, const std::string& input, const std::string& output,
+                               const StreamOptions& options) {
+    cv::VideoCapture capture;
+    if (!openInput(input, capture)) {
+        throw std::runtime_error("could not open video input: " + input);
+    }
+
+    double fps = capture.get(cv::CAP_PROP_FPS);
+    if (fps <= 0.0) {
+        fps = 25.0;
+    }
+
+    const bool sequence = isImageSequence(output);
+
+    BoundedQueue<StreamFrame> decoded(options.queue_capacity);
+    BoundedQueue<StreamFrame> processed(options.queue_capacity);
+
+    StageStats decode_stats{"decode"};
+    StageStats process_stats{"process"};
+    StageStats encode_stats{"encode"};
+
+    // the first failure stops every stage; it is rethrown once all threads are joined
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = e;
+            }
+        }
+        decoded.close();
+        processed.close();
+    };
+
+    // frames of an image sequence are independent files, so several threads may encode them
+    const size_t encode_workers = sequence ? std::max<size_t>(1, options.encode_workers) : 1;
+    const std::vector<int> encode_params = options.encode.params();
+
+    // one frame is processed at a time; decode and encode keep their threads out of the budget
+    SchedulePlan split = Scheduler::shared().plan(1, 1, 1 + encode_workers);
+
+    auto start = Clock::now();
+
+    std::thread decoder([&] {
+        try {
+            for (size_t index = 0;; ++index) {
+                auto busy_start = Clock::now();
+                StreamFrame frame;
+                frame.index = index;
+                if (!capture.read(frame.image) || frame.image.empty()) {
+                    break;
+                }
+                decode_stats.busy_seconds += secondsSince(busy_start);
+                ++decode_stats.frames;
+
+                if (!decoded.push(std::move(frame))) {
+                    break;
+                }
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        decoded.close();
+    });
+
+    std::thread processor([&] {
+        try {
+            PipelineExecutor executor;
+            executor.setTileSize(options.tile_size);
+            executor.setTrace(options.trace);
+
+            // compiled for the stream's frame size on the first frame
+            std::unique_ptr<CompiledPipeline> pipeline;
+            cv::Size plan_size;
+
+            StreamFrame frame;
+            while (decoded.pop(frame)) {
+                auto busy_start = Clock::now();
+                if (!pipeline || frame.image.size() != plan_size) {
+                    plan_size = frame.image.size();
+                    OptimizeOptions rewrite;
+                    rewrite.depth = frame.image.depth();
+                    rewrite.blur_tolerance = options.blur_tolerance;
+                    PipelineConfig sized = options.optimize ? PipelineOptimizer::optimize(config, plan_size, rewrite) : config;
+                    pipeline = std::make_unique<CompiledPipeline>(PipelineCompiler::compile(sized));
+                }
+
+                frame.image = executor.runInPlace(*pipeline, frame.image);
+                process_stats.busy_seconds += secondsSince(busy_start);
+                ++process_stats.frames;
+
+                if (!processed.push(std::move(frame))) {
+                    break;
+                }
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        processed.close();
+    });
+
+    std::mutex encode_mutex;
+    auto encode = [&] {
+        try {
+            cv::VideoWriter writer;
+            cv::Size writer_size;
+            int writer_channels = 0;
+            StageStats stats;
+
+            StreamFrame frame;
+            while (processed.pop(frame)) {
+                auto busy_start = Clock::now();
+                if (sequence) {
+                    std::string path = formatFrameName(output, frame.index);
+                    if (!cv::imwrite(path, frame.image, encode_params)) {
+                        throw std::runtime_error("could not save frame to '" + path + "'");
+                    }
+                } else {
+                    // opened lazily: the pipeline may change the frame size
+                    if (!writer.isOpened()) {
+                        if (!writer.open(output, fourccFor(output), fps, frame.image.size(), frame.image.channels() == 3)) {
+                            throw std::runtime_error("could not open video output: " + output);
+                        }
+                        if (options.encode.jpeg_quality >= 0) {
+                            writer.set(cv::VIDEOWRITER_PROP_QUALITY, options.encode.jpeg_quality);
+                        }
+                        writer_size = frame.image.size();
+                        writer_channels = frame.image.channels();
+                    }
+                    // VideoWriter::write reports nothing, and backends silently drop frames
+                    // that do not match the size and channels the output was opened with
+                    if (frame.image.size() != writer_size || frame.image.channels() != writer_channels) {
+                        throw std::runtime_error("frame " + std::to_string(frame.index) + " is "
+                                                 + std::to_string(frame.image.cols) + "x" + std::to_string(frame.image.rows)
+                                                 + ", the video output was opened at " + std::to_string(writer_size.width)
+                                                 + "x" + std::to_string(writer_size.height));
+                    }
+                    writer.write(frame.image);
+                }
+                frame.image.release();
+                stats.busy_seconds += secondsSince(busy_start);
+                ++stats.frames;
+            }
+
+            std::lock_guard<std::mutex> lock(encode_mutex);
+            encode_stats.busy_seconds += stats.busy_seconds;
+            encode_stats.frames += stats.frames;
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+
+    std::vector<std::thread> encoders;
+    for (size_t i = 0; i < encode_workers; ++i) {
+        encoders.emplace_back(encode);
+    }
+
+    decoder.join();
+    processor.join();
+    for (auto& encoder : encoders) {
+        encoder.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    // the writers are closed now; a container the backend could not write is missing or empty
+    std::error_code missing;
+    uintmax_t written = sequence ? 0 : std::filesystem::file_size(output, missing);
+    if (!sequence && encode_stats.frames > 0 && (missing || written == 0)) {
+        throw std::runtime_error("could not write video output: " + output);
+    }
+
+    decode_stats.output_wait_seconds = decoded.pushWaitSeconds();
+    process_stats.input_wait_seconds = decoded.popWaitSeconds();
+    process_stats.output_wait_seconds = processed.pushWaitSeconds();
+    encode_stats.input_wait_seconds = processed.popWaitSeconds();
+
+    StreamResult result;
+    result.frames = encode_stats.frames;
+    result.seconds = secondsSince(start);
+    result.threads_per_frame = split.intra_threads;
+    result.encode_workers = encode_workers;
+    result.stages = {decode_stats, process_stats, encode_stats};
+    return result;
+}
+
+void StreamRunner::printReport(const StreamResult& result) {
+    std::cout << "stream completed: " << result.frames << " frames in " << result.seconds << " s";
+    if (result.seconds > 0.0) {
+        std::cout << " (" << std::fixed << std::setprecision(1) << result.frames / result.seconds << " fps)";
+    }
+    std::cout << std::endl;
+    std::cout << "  opencv threads per frame: " << result.threads_per_frame << ", encode threads: "
+              << result.encode_workers << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto& stage : result.stages) {
+        std::cout << "  " << stage.name << ": " << stage.frames << " frames, busy " << stage.busy_seconds
+                  << " s, starved " << stage.input_wait_seconds << " s, blocked by downstream "
+                  << stage.output_wait_seconds << " s" << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+bool StreamRunner::openInput(const std::string& input, cv::VideoCapture& capture) {
+    bool is_device = !input.empty() && std::all_of(input.begin(), input.end(),
+                                                   [](unsigned char c) { return std::isdigit(c); });
+    if (is_device) {
+        return capture.open(std::stoi(input));
+    }
+    return capture.open(input);
+}
+
+bool StreamRunner::isImageSequence(const std::string& output) {
+    return output.find('%') != std::string::npos;
+}
+
+std::string StreamRunner::formatFrameName(const std::string& pattern, size_t index) {
+    // accept exactly "%d" or "%0<width>d", nothing that could read other arguments
+    size_t percent = pattern.find('%');
+    size_t pos = percent + 1;
+    int width = 0;
+    if (pos < pattern.size() && pattern[pos] == '0') {
+        ++pos;
+    }
+    while (pos < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[pos]))) {
+        width = width * 10 + (pattern[pos] - '0');
+        ++pos;
+    }
+    if (pos >= pattern.size() || pattern[pos] != 'd' || pattern.find('%', pos) != std::string::npos) {
+        throw std::runtime_error("image sequence pattern must contain a single %d or %0Nd: " + pattern);
+    }
+
+    std::string number = std::to_string(index);
+    if (static_cast<int>(number.size()) < width) {
+        number.insert(0, width - number.size(), '0');
+    }
+    return pattern.substr(0, percent) + number + pattern.substr(pos + 1);
+}
+
+int StreamRunner::fourccFor(const std::string& output) {
+    std::string extension = std::filesystem::path(output).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".mp4") {
+        return cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+    }
+    if (extension == ".mkv") {
+        return cv::VideoWriter::fourcc('X', '2', '6', '4');
+    }
+    // motion jpeg in avi is available without ffmpeg
+    return cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+}
@@ -0,0 +1,46 @@
+#include "../hpp/tile_planner.hpp"
+#include <algorithm>
+
+bool TilePlanner::isTileable(const CompiledStep& step) {
+    return step.roi.full_image
+        && step.operation->footprint(step.parameters).kind != Footprint::Kind::Geometry;
+}
+
+size_t TilePlanner::tileableRunEnd(const CompiledPipeline& pipeline, size_t begin) {
+    size_t end = begin;
+    while (end < pipeline.steps.size() && isTileable(pipeline.steps[end])) {
+        ++end;
+    }
+    return end;
+}
+
+int TilePlanner::haloRadius(const CompiledPipeline& pipeline, size_t begin, size_t end) {
+    // each neighbourhood step corrupts `radius` pixels at the edge of an isolated tile,
+    // so the halo has to absorb all of them
+    int halo = 0;
+    for (size_t i = begin; i < end; ++i) {
+        const auto& step = pipeline.steps[i];
+        halo += step.operation->footprint(step.parameters).radius;
+    }
+    return halo;
+}
+
+std::vector<Tile> TilePlanner::planTiles(cv::Size image_size, int tile_size, int halo) {
+    std::vector<Tile> tiles;
+    const cv::Rect bounds(0, 0, image_size.width, image_size.height);
+
+    for (int y = 0; y < image_size.height; y += tile_size) {
+        for (int x = 0; x < image_size.width; x += tile_size) {
+            Tile tile;
+            tile.core = cv::Rect(x, y, tile_size, tile_size) & bounds;
+
+            // at the true image border the padded tile ends at the border too, so filters
+            // reflect there exactly as they do on the whole image
+            tile.padded = cv::Rect(tile.core.x - halo, tile.core.y - halo,
+                                   tile.core.width + 2 * halo, tile.core.height + 2 * halo) & bounds;
+            tiles.push_back(tile);
+        }
+    }
+
+    return tiles;
+}
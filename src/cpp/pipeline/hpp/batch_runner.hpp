@@ -0,0 +1,106 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "pipeline_compiler.hpp"
+#include "image_loader.hpp"
+#include "image_writer.hpp"
+#include "result_cache.hpp"
+#include "../../runtime/hpp/trace_recorder.hpp"
+
+/**
+ * one image of a batch job
+ */
+struct BatchItem {
+    std::string input_image;
+    std::string output_image;
+};
+
+/**
+ * settings for a batch job
+ */
+struct BatchOptions {
+    size_t workers = 0;              // cap on image workers, 0 lets the scheduler pick
+    bool optimize = true;
+    double blur_tolerance = 0.0;     // see OptimizeOptions
+    bool fast_decode = false;        // decode jpegs at reduced size when the pipeline starts by shrinking them
+    size_t encode_workers = 1;       // threads of the encode stage, 0 encodes on the image workers
+    size_t queue_capacity = 4;       // processed images waiting for the encode stage
+    EncodeOptions encode;
+    TraceRecorder* trace = nullptr;
+    ResultCache* result_cache = nullptr;   // outputs looked up before decoding and kept once written
+};
+
+/**
+ * summary of a finished batch job
+ */
+struct BatchResult {
+    size_t succeeded = 0;
+    size_t failed = 0;
+    double seconds = 0.0;
+    size_t workers = 0;          // images processed at the same time
+    int threads_per_image = 0;   // opencv threads each image could use
+    size_t encode_workers = 0;   // threads of the encode stage (0: images encoded by their worker)
+    double encode_busy_seconds = 0.0;
+    double encode_wait_seconds = 0.0;   // image workers blocked on a full encode queue
+};
+
+// batch runner class - one pipeline over many images on a worker pool
+class BatchRunner {
+public:
+    // expand a directory, glob pattern (e.g. data/*.jpg) or manifest file into batch items;
+    // manifest lines are "<input> [output]", outputs default to output_dir/<input file name>
+    static std::vector<BatchItem> collectItems(const std::string& input_spec, const std::string& output_dir);
+
+    // compile the pipeline once per input size and run it over every item; each worker decodes
+    // and processes its own image and hands the result to the encode stage, so decode, process
+    // and encode overlap across images. the shared scheduler keeps the encode threads out of its
+    // budget and splits the rest into at most `workers` image workers and the opencv threads
+    // left for each image
+    static BatchResult run(const PipelineConfig& config, const std::vector<BatchItem>& items, const BatchOptions& options);
+
+private:
+    // compiled pipelines shared by all workers, one per input size and depth (optimizer rewrites
+    // depend on them) and, for reduced decodes, per encoded size (the rewritten resize depends on that)
+    class PlanSet {
+    public:
+        PlanSet(const PipelineConfig& config, const BatchOptions& options);
+
+        // true if the pipeline leaves images unchanged, so outputs may be copies of the inputs
+        bool isIdentity() const;
+
+        // the pipeline and settings as the result cache keys them
+        const std::string& description() const;
+
+        // decode an image as cheaply as the pipeline allows
+        DecodePlan load(const std::string& path, cv::Mat& image) const;
+
+        // compiled pipeline for an image of this depth decoded by load
+        const CompiledPipeline& forDecode(const DecodePlan& decode, int depth);
+
+    private:
+        const PipelineConfig& config;
+        bool optimize;
+        double blur_tolerance;
+        bool fast_decode;
+        bool identity;
+        std::string cache_description;
+        std::mutex mutex;
+        std::map<std::tuple<int, int, int, int, int, int>, std::unique_ptr<CompiledPipeline>> plans;
+    };
+
+    // decode and process a single image, then queue it on the writer or, without one, encode it
+    static bool processItem(PlanSet& plans, const BatchItem& item, const BatchOptions& options, ImageWriter* writer);
+
+    // true for file extensions opencv can decode
+    static bool isImageFile(const std::string& path);
+
+    // shell-style wildcard match supporting '*' and '?'
+    static bool matchesWildcard(const std::string& name, const std::string& pattern);
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "pipeline_compiler.hpp"
+#include "pipeline_optimizer.hpp"
+#include "../../runtime/hpp/trace_recorder.hpp"
+
+/**
+ * node of a compiled graph, planned for the size of the image it receives
+ */
+struct CompiledNode {
+    std::string name;
+    int input = -1;             // index of the node it reads from, -1 for the decoded image
+    size_t consumers = 0;       // nodes reading its result
+    cv::Size input_size;
+    PipelineConfig config;      // the node's operations after optimization
+    CompiledPipeline pipeline;
+};
+
+/**
+ * pipeline graph ready for execution, nodes in dependency order
+ */
+struct CompiledGraph {
+    std::vector<CompiledNode> nodes;
+    size_t image_consumers = 0; // nodes reading the decoded image
+};
+
+// graph executor class - runs every node of a compiled graph exactly once, so a prefix shared
+// by several outputs is computed a single time, and runs nodes whose inputs are ready (the
+// independent branches) at the same time on the scheduler's frame workers
+class GraphExecutor {
+public:
+    // optimize every node for the size of the image it will receive and compile it
+    static CompiledGraph compile(const PipelineGraph& graph, cv::Size input_size, bool optimize = true,
+                                 const OptimizeOptions& options = OptimizeOptions());
+
+    // most nodes that can run at the same time: one per branch ending in a leaf
+    static size_t branchCount(const CompiledGraph& graph);
+
+    explicit GraphExecutor(int tile_size = 0, TraceRecorder* trace = nullptr);
+
+    // run the graph over an image the caller hands over; returns the result of every node
+    // with an output_image, keyed by node name. intermediate results are dropped as soon as
+    // their last reader is done
+    std::map<std::string, cv::Mat> run(const CompiledGraph& graph, cv::Mat& image);
+
+private:
+    int tile_size;
+    TraceRecorder* trace;
+
+    // run one node on its input, in place when nothing else reads that input
+    cv::Mat runNode(const CompiledNode& node, cv::Mat& input, bool in_place) const;
+};
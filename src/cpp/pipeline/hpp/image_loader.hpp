@@ -0,0 +1,60 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+
+/**
+ * how to decode an input image for a pipeline, and the pipeline to run on the result
+ */
+struct DecodePlan {
+    int flags = cv::IMREAD_COLOR;   // imread flags, a reduced mode when the pipeline starts by shrinking
+    int reduction = 1;              // 1, 2, 4 or 8
+    cv::Size source_size;           // size of the encoded image (empty when not read up front)
+    cv::Size decoded_size;          // size the decoder will produce
+    PipelineConfig config;          // the pipeline, its leading crop and resize moved to the decoded scale
+};
+
+// image loader class - decodes inputs as cheaply as their pipeline allows. a jpeg whose
+// pipeline starts by shrinking it (optionally after a crop) at least 2x is scaled by the
+// decoder in the dct domain (IMREAD_REDUCED_*), which skips most of the inverse dct and
+// color conversion; this is close to, but not pixel-identical with, a full decode. raw
+// (.svraw) files are never decoded: the image is mapped straight from the file
+class ImageLoader {
+public:
+    // pixel size from a jpeg's frame header without decoding it, false for other files
+    static bool readJpegSize(const std::string& path, cv::Size& size);
+
+    // plan the decode of a jpeg of the given size; the leading crop and resize are rewritten
+    // for the reduced image, so the pipeline still produces the same output size
+    static DecodePlan planDecode(const PipelineConfig& config, cv::Size source_size);
+
+    // decode into `image` (reusing its buffer when the size matches); with fast_decode, upright
+    // jpegs take the planned reduced decode. exif-oriented ones are decoded in full, as is
+    // anything the decoder disagrees with the plan about; returns the plan actually used
+    static DecodePlan load(const std::string& path, const PipelineConfig& config, bool fast_decode, cv::Mat& image);
+
+    // full-size read: raw files are mapped, anything else is decoded into `image`
+    static void read(const std::string& path, cv::Mat& image, int flags = cv::IMREAD_COLOR);
+
+    // write an image, raw files through a mapping and anything else encoded by extension
+    // with the given imwrite parameters (ignored for raw files)
+    static bool save(const std::string& path, const cv::Mat& image, const std::vector<int>& params = {});
+
+    // for pipelines that leave the pixels unchanged: copy the encoded file to `output_path`
+    // instead of decoding and re-encoding it, which also keeps its metadata and avoids a second
+    // lossy encode. false (nothing written) unless both paths have the same format by extension,
+    // no encoder parameters are given and the input is one a color decode would not change:
+    // an 8-bit, 3-component jpeg without an exif rotation or an 8-bit rgb png without exif
+    // (anything else is rotated, converted to 3 channels or 8 bits by the decode, so a copy
+    // would differ). raw files are mapped rather than decoded, so are not copied
+    static bool copyUnchanged(const std::string& path, const std::string& output_path, const std::vector<int>& params);
+
+private:
+    // true for the inputs copyUnchanged may copy, judged from their headers
+    static bool decodesUnchanged(const std::string& path);
+
+    // imread flags of the color decode reduced by 2, 4 or 8
+    static int reducedFlags(int reduction);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../../runtime/hpp/bounded_queue.hpp"
+
+/**
+ * encoder settings for written images; -1 keeps opencv's default for the format
+ */
+struct EncodeOptions {
+    int jpeg_quality = -1;      // 0-100 (opencv default 95)
+    int png_compression = -1;   // zlib level 0-9 (opencv default 1, fastest)
+    int webp_quality = -1;      // 1-100 lossy, above 100 lossless (opencv default 100)
+
+    // imwrite parameters for the options that are set
+    std::vector<int> params() const;
+};
+
+/**
+ * summary of an image writer's work
+ */
+struct WriterStats {
+    size_t written = 0;
+    size_t failed = 0;
+    double busy_seconds = 0.0;          // encode and write time summed over workers
+    double submit_wait_seconds = 0.0;   // producers blocked on a full queue
+};
+
+// image writer class - the encode stage of a batch. images are queued by the workers that
+// produced them and encoded and written on the writer's own threads, so processing the next
+// image overlaps with encoding the last; a full queue blocks submit, which bounds the memory
+// held by pending images
+class ImageWriter {
+public:
+    ImageWriter(size_t workers, size_t queue_capacity, const EncodeOptions& options);
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    // queue an image for writing; the writer keeps a reference, so the caller must not write
+    // into it afterwards. `written`, if set, runs on the writer thread once the file is saved.
+    // false once the writer has finished
+    bool submit(const std::string& path, const cv::Mat& image, std::function<void()> written = nullptr);
+
+    // write everything still queued, join the workers and report
+    WriterStats finish();
+
+private:
+    struct Job {
+        std::string path;
+        cv::Mat image;
+        std::function<void()> written;
+    };
+
+    // worker loop, encodes queued images until the queue is closed and drained
+    void work();
+
+    const std::vector<int> params;
+    BoundedQueue<Job> queue;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    WriterStats stats;
+};
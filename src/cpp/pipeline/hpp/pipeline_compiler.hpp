@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include "../../operations/hpp/base_operation.hpp"
+#include "../../bindings/hpp/pipeline_reader.hpp"
+
+/**
+ * single executable step of a compiled pipeline
+ */
+struct CompiledStep {
+    std::string type;
+    std::unique_ptr<Operation> operation;
+    std::map<std::string, double> parameters;
+    ROI roi;
+    std::string signature;   // the step's operations, exact parameters and roi as text, equal for equal steps
+};
+
+/**
+ * pipeline ready for execution, one step per operation or fused run; every
+ * operation is prepared, so a plan is read-only and can be shared between threads
+ */
+struct CompiledPipeline {
+    std::vector<CompiledStep> steps;
+};
+
+// pipeline compiler class
+class PipelineCompiler {
+public:
+    // turn a parsed pipeline configuration into executable, prepared steps (throws on invalid parameters)
+    static CompiledPipeline compile(const PipelineConfig& config, bool fuse_pointwise = true);
+
+    // check up front that a pipeline would compile, without preparing anything: throws as
+    // compile does on unknown operations and invalid parameters. for callers that parse a
+    // pipeline once and compile it per input size later
+    static void validate(const PipelineConfig& config);
+
+    // resolve the roi a step runs on (its own or the pipeline-wide one)
+    static ROI resolveROI(const PipelineConfig& config, const OperationConfig& op_config);
+
+    // canonical text of a single operation step: its type, exact parameters and roi (omitted
+    // when full), equal for steps that produce equal output; the key text of every cache
+    static std::string signature(const std::string& type, const std::map<std::string, double>& parameters, const ROI& roi);
+
+private:
+
+    // true if two rois cover the same region
+    static bool sameROI(const ROI& a, const ROI& b);
+
+    // collapse runs of pointwise steps sharing a roi into fused steps
+    static std::vector<CompiledStep> fusePointwise(std::vector<CompiledStep> steps);
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "pipeline_compiler.hpp"
+#include "tile_planner.hpp"
+#include "step_cache.hpp"
+#include "../../runtime/hpp/buffer_pool.hpp"
+#include "../../runtime/hpp/trace_recorder.hpp"
+#include <vector>
+
+// pipeline executor class - owns the buffer pool its steps draw from, so keep one
+// executor per thread and reuse it across frames for an allocation-free steady state
+class PipelineExecutor {
+public:
+    explicit PipelineExecutor(bool verbose = false);
+
+    // run every step over a copy of the image, the caller's image is left untouched
+    cv::Mat run(const CompiledPipeline& pipeline, const cv::Mat& image);
+
+    // run every step over an image the caller hands over (e.g. a freshly decoded frame);
+    // its buffer is overwritten by in-place steps and may be returned as the result
+    cv::Mat runInPlace(const CompiledPipeline& pipeline, cv::Mat& image);
+
+    // compute only the given region of the result (in output coordinates): the region is
+    // propagated backwards through the step footprints and each step runs on the part of its
+    // input that region depends on. pixel-identical to cropping the result of run
+    cv::Mat runRegion(const CompiledPipeline& pipeline, const cv::Mat& image, const cv::Rect& region);
+
+    // like run, but keeps the image after every step but the last in `cache` under a hash of
+    // `input_key` (identifying the input) and the steps so far; a later call sharing a prefix
+    // with an earlier one, e.g. with only a later parameter changed, resumes after the longest
+    // cached prefix. `reused` reports how many steps were skipped that way
+    cv::Mat runMemoized(const CompiledPipeline& pipeline, const cv::Mat& image, uint64_t input_key, StepCache& cache,
+                        size_t* reused = nullptr);
+
+    // give a buffer back once the caller is done with it (e.g. after encoding the result)
+    void recycle(cv::Mat& buffer);
+
+    // pool backing this executor
+    BufferPool& bufferPool();
+
+    // run chains of whole-image steps tile by tile (0 disables tiling); tiles spread over the
+    // intra-frame threads of the scheduler's current plan
+    void setTileSize(int tile_size);
+
+    // record every step and its operation phases into a trace; with nullptr, steps
+    // still go to a recorder the caller made current
+    void setTrace(TraceRecorder* trace);
+
+private:
+    BufferPool pool;
+    bool verbose;
+    int tile_size = 0;
+    TraceRecorder* trace = nullptr;
+    std::vector<cv::Mat> tile_buffers; // one per tile worker, grown to the largest padded tile
+
+    // run steps [begin, end) on the working image
+    void runSteps(const CompiledPipeline& pipeline, size_t begin, size_t end, cv::Mat& image);
+
+    // run one step on the working image
+    void runStep(const CompiledStep& step, cv::Mat& image);
+
+    // run steps [begin, end) tile by tile, every tile going through the whole chain
+    void runTiled(const CompiledPipeline& pipeline, size_t begin, size_t end, cv::Mat& image);
+};
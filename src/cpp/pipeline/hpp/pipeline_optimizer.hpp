@@ -0,0 +1,77 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+
+/**
+ * what the optimizer may assume about the input beyond its size
+ */
+struct OptimizeOptions {
+    int depth = CV_8U;              // channel depth; brightness and contrast are only simplified for 8-bit
+    double blur_tolerance = 0.0;    // change (in 8-bit levels) allowed for merging two blurs, 0 keeps them apart
+};
+
+// pipeline optimizer class - pixel-exact rewrites of a parsed pipeline, plus the opt-in
+// merging of blurs, which is close but not exact
+class PipelineOptimizer {
+public:
+    // apply every rewrite for an input image of the given size
+    static PipelineConfig optimize(const PipelineConfig& config, cv::Size input_size,
+                                   const OptimizeOptions& options = OptimizeOptions());
+
+    // algebraic rewrites: drop steps that leave the image as it is (brightness and contrast
+    // whose table is the identity, full-frame crops, same-size resizes) and merge neighbours
+    // into one step: brightness and contrast runs into a single brightness or contrast whose
+    // 8-bit table equals the run's (so clamping between them is kept exactly), and two blurs
+    // into one of sigma sqrt(s1^2 + s2^2) when that stays within options.blur_tolerance.
+    // crops and resizes are only judged for a known (non-empty) input size
+    static PipelineConfig simplify(const PipelineConfig& config, cv::Size input_size, const OptimizeOptions& options);
+
+    // true if the pipeline leaves every 8-bit image unchanged, whatever its size
+    static bool isIdentity(const PipelineConfig& config);
+
+    // move each crop as early as is exact: past pointwise steps unchanged, past blur/sharpen
+    // expanded by their radius with a trailing crop to trim the margin; adjacent crops are merged
+    static PipelineConfig pushDownCrops(const PipelineConfig& config, cv::Size input_size);
+
+    // size of the image the pipeline produces from an input of the given size
+    static cv::Size outputSize(const PipelineConfig& config, cv::Size input_size);
+
+    // resolve a crop's rectangle on a frame of the given size, false if the crop would fail
+    static bool resolveCrop(const OperationConfig& op, cv::Size frame_size, cv::Rect& rect);
+
+    // one line per operation, e.g. "  2. blur kernel_size=7 sigma=1.5"
+    static std::string describe(const PipelineConfig& config);
+
+private:
+    // true if step `index` leaves its input unchanged
+    static bool isIdentityStep(const PipelineConfig& config, size_t index, cv::Size frame_size, const OptimizeOptions& options);
+
+    // one brightness or contrast step equivalent to `first` followed by `second`, false if none is
+    static bool mergePointwise(const PipelineConfig& config, const OperationConfig& first,
+                               const OperationConfig& second, OperationConfig& merged);
+
+    // one blur standing in for `first` followed by `second` within the tolerance, false if none does
+    static bool mergeBlurs(const PipelineConfig& config, const OperationConfig& first,
+                           const OperationConfig& second, double tolerance, OperationConfig& merged);
+
+    // 8-bit table of a valid brightness or contrast step, empty otherwise
+    static cv::Mat pointwiseTable(const OperationConfig& op);
+
+    // region a step applies to, the pipeline's roi unless it has its own
+    static const ROI& regionOf(const PipelineConfig& config, const OperationConfig& op);
+
+    // true if a step's region lies inside a frame of the given size (always for the full image,
+    // never for an roi on a frame of unknown size)
+    static bool regionFits(const ROI& roi, cv::Size frame_size);
+
+    // true if a crop may move in front of this operation; adds its neighbourhood radius
+    static bool canMoveCropBefore(const PipelineConfig& config, const OperationConfig& op, int& radius);
+
+    // image size in front of operation `index`
+    static cv::Size frameSizeAt(const PipelineConfig& config, size_t index, cv::Size input_size);
+
+    // crop operation with explicit x, y, width and height
+    static OperationConfig makeCrop(const cv::Rect& rect);
+};
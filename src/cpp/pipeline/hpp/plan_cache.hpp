@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <opencv2/opencv.hpp>
+#include "pipeline_compiler.hpp"
+
+// compiled plans cached by a content hash of the pipeline json, so a repeated
+// submission skips parsing, validation, optimization and table construction;
+// thread-safe, least recently used plans are dropped first
+class PlanCache {
+public:
+    explicit PlanCache(size_t capacity = 64, bool optimize = true, double blur_tolerance = 0.0);
+
+    // plan for pipeline json text (a file's contents or an inline document) at this input size
+    // and channel depth; `hit` reports whether it came from the cache
+    std::shared_ptr<const CompiledPipeline> get(const std::string& pipeline_text, cv::Size input_size, int depth,
+                                                bool* hit = nullptr);
+
+    // plan for a pipeline file, keyed by its contents rather than its path
+    std::shared_ptr<const CompiledPipeline> getFile(const std::string& path, cv::Size input_size, int depth,
+                                                    bool* hit = nullptr);
+
+    size_t size() const;
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::string text;   // compared on a hash match, so a collision is only a miss
+        cv::Size size;
+        int depth;
+        std::shared_ptr<const CompiledPipeline> plan;
+    };
+
+    size_t capacity;
+    bool optimize;
+    double blur_tolerance;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+
+    // parse, optimize for the size and depth and compile
+    std::shared_ptr<const CompiledPipeline> build(const std::string& pipeline_text, cv::Size input_size, int depth) const;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "pipeline_compiler.hpp"
+
+/**
+ * part one step plays in a region run, with the input pixels it needs
+ */
+struct RegionStep {
+    enum class Mode {
+        Region,     // runs on the region image (whole-image pointwise and neighbourhood steps)
+        Remap,      // whole-image crop: only moves the region into the cropped frame
+        Whole       // needs its whole input frame (roi-limited steps, crops that would fail)
+    };
+
+    Mode mode = Mode::Region;
+    cv::Rect required;      // input pixels the step needs, in its input frame
+    cv::Rect crop;          // remap only: the crop in the input frame
+};
+
+/**
+ * demand-driven plan for one requested output region
+ */
+struct RegionPlan {
+    size_t begin = 0;               // first planned step; steps before it run on the whole image
+    std::vector<RegionStep> steps;  // one per step from begin on
+    cv::Rect output;                // requested region, clipped to the output frame
+    double fraction = 1.0;          // share of a full run's step pixels the region run computes
+};
+
+// region planner class - propagates a requested output rectangle backwards through the
+// footprints of the steps, so only the pixels it depends on are computed
+class RegionPlanner {
+public:
+    // first step the region can be planned from: steps up to the last one whose output
+    // geometry is not known in advance run in full
+    static size_t regionStart(const CompiledPipeline& pipeline);
+
+    // plan steps [begin, end) for an image of input_size at step begin and a region of the
+    // final output (throws if the region misses the output frame)
+    static RegionPlan plan(const CompiledPipeline& pipeline, size_t begin, cv::Size input_size, const cv::Rect& region);
+
+private:
+    // how a step takes part, and its crop rectangle for remaps
+    static RegionStep::Mode modeOf(const CompiledStep& step, cv::Size frame_size, cv::Rect& crop);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+
+// on-disk cache of encoded outputs keyed by what produced them: the input (a hash of its bytes,
+// or path, size and modification time in fast mode), the pipeline and the settings that shape
+// the output. a hit copies the stored file to the output path, skipping decode, processing and
+// encode. entries are named by the sha-256 of all of that plus the output's extension, and
+// other files in the directory are left alone. thread-safe; entries are published by atomic
+// rename, and a miss looks for the entry on disk, so several processes may share a directory.
+// least recently used entries are removed once the directory's total size exceeds the bound
+class ResultCache {
+public:
+    // cache in `directory` (created if missing) holding at most max_bytes of outputs; existing
+    // entries are picked up, oldest first out, and temporary files of crashed runs removed
+    ResultCache(const std::string& directory, uint64_t max_bytes, bool fast_keys);
+
+    // canonical text of a pipeline, each operation as its compiled step's signature, and the
+    // settings that change its output (reduced decodes, merged blurs, encoder parameters).
+    // blur_tolerance is 0 when the optimizer does not run
+    static std::string describe(const PipelineConfig& config, bool fast_decode, double blur_tolerance,
+                                const std::vector<int>& encode_params);
+
+    // key for writing `output_path` from `input_path` with a pipeline given by describe: the
+    // sha-256 of the input's identity, the output format (by extension) and the pipeline, so
+    // equal keys mean equal outputs. empty if the input cannot be read
+    std::string key(const std::string& input_path, const std::string& output_path, const std::string& pipeline) const;
+
+    // copy the stored output for the key to output_path, false on a miss
+    bool fetch(const std::string& key, const std::string& output_path);
+
+    // keep a copy of the output just written for the key, then evict down to the size bound
+    void store(const std::string& key, const std::string& output_path);
+
+    size_t hits() const;
+    size_t misses() const;
+    uint64_t bytes() const;
+
+private:
+    struct Entry {
+        std::string name;   // file name in the directory: the key and the output's extension
+        uint64_t bytes;
+    };
+
+    std::string directory;
+    uint64_t max_bytes;
+    bool fast_keys;
+    std::chrono::steady_clock::time_point scanned;   // last time the index was rebuilt from disk
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t total_bytes = 0;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+
+    // rebuild the index from the entries on disk, which other processes may have added or
+    // removed, then evict down to the bound; mutex not held
+    void rescan();
+
+    // drop least recently used entries (and their files) beyond the bound; mutex held
+    void evict();
+
+    // entry file name for a key and the output it stands for
+    static std::string entryName(const std::string& key, const std::string& output_path);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// intermediate images of recent runs, keyed by a hash of the input and the steps that produced
+// them (a prefix of the pipeline), so a rerun that only changes a later step resumes from the
+// last unchanged one; thread-safe, least recently used images are dropped beyond the byte budget
+class StepCache {
+public:
+    explicit StepCache(size_t max_bytes);
+
+    // key of a prefix (ContentHash::fnv1a of the input for the empty one) followed by one
+    // more step (its signature)
+    static uint64_t extend(uint64_t key, const std::string& step);
+
+    // image stored under the key, shared with the cache and so read-only; false if there is none
+    bool find(uint64_t key, cv::Mat& image);
+
+    // keep a copy of the image under the key, then evict down to the budget
+    void store(uint64_t key, const cv::Mat& image);
+
+    // like store, for an image computed from the one under `parent`: it ranks just behind its
+    // parent in recency (or last, once the parent is gone), so eviction reaches a chain's
+    // deeper images before the shallower ones every rerun resumes from
+    void storeAfter(uint64_t parent, uint64_t key, const cv::Mat& image);
+
+    // like store, but keep the image itself, which the caller must no longer write into
+    void adopt(uint64_t key, const cv::Mat& image);
+
+    // mark a chain of keys (an input and the prefixes computed from it, shallowest first) as
+    // used, the shallowest most recently
+    void touch(const std::vector<uint64_t>& chain);
+
+    size_t size() const;
+    size_t bytes() const;
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        cv::Mat image;
+        size_t bytes;
+    };
+
+    // put the entry first, or behind `parent` if given (last if the parent is gone), and evict
+    // down to the budget; mutex held
+    void insert(Entry entry, const uint64_t* parent = nullptr);
+
+    size_t max_bytes;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t total_bytes = 0;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "../../runtime/hpp/trace_recorder.hpp"
+#include "image_writer.hpp"
+
+/**
+ * settings for a streaming run
+ */
+struct StreamOptions {
+    size_t queue_capacity = 4;
+    bool optimize = true;
+    double blur_tolerance = 0.0;      // see OptimizeOptions
+    int tile_size = 0;
+    TraceRecorder* trace = nullptr;   // per-step trace of the process stage
+    EncodeOptions encode;             // jpeg quality also applies to motion jpeg video
+    size_t encode_workers = 1;        // image sequences only, a video file is written in order by one thread
+};
+
+/**
+ * timing of one stage of a streaming run
+ */
+struct StageStats {
+    std::string name;
+    size_t frames = 0;
+    double busy_seconds = 0.0;
+    double input_wait_seconds = 0.0;   // starved: waiting on the upstream queue
+    double output_wait_seconds = 0.0;  // backpressure: waiting on a full downstream queue
+};
+
+/**
+ * summary of a finished streaming run
+ */
+struct StreamResult {
+    size_t frames = 0;
+    double seconds = 0.0;
+    int threads_per_frame = 0;   // opencv threads the process stage could use
+    size_t encode_workers = 0;   // threads of the encode stage
+    std::vector<StageStats> stages;
+};
+
+// stream runner class - decode, process and encode threads joined by bounded queues
+class StreamRunner {
+public:
+    // run the pipeline over every frame of a video file or camera (a device index such as "0");
+    // output is a video file (.avi, .mp4, .mkv) or an image sequence pattern such as frames/out_%05d.jpg
+    static StreamResult run(const PipelineConfig& config, const std::string& input, const std::string& output,
+                            const StreamOptions& options);
+
+    // print per-stage throughput and backpressure
+    static void printReport(const StreamResult& result);
+
+private:
+    // open a video file, or a camera when the input is a plain device index
+    static bool openInput(const std::string& input, cv::VideoCapture& capture);
+
+    // true if the output names an image sequence rather than a video file
+    static bool isImageSequence(const std::string& output);
+
+    // expand the single %d / %0Nd of an image sequence pattern
+    static std::string formatFrameName(const std::string& pattern, size_t index);
+
+    // fourcc for a video container, picked from the file extension
+    static int fourccFor(const std::string& output);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "pipeline_compiler.hpp"
+
+/**
+ * one tile of a tiled run: the pixels it produces and the padded region it reads
+ */
+struct Tile {
+    cv::Rect core;
+    cv::Rect padded;
+};
+
+// tile planner class - splits runs of steps into cache-sized tiles with halos
+class TilePlanner {
+public:
+    // default tile edge in pixels (a 3-channel 8-bit tile plus halo stays within L2)
+    static constexpr int default_tile_size = 256;
+
+    // true if a step can run tile by tile (whole image, no geometry change)
+    static bool isTileable(const CompiledStep& step);
+
+    // end of the run of tileable steps starting at begin (begin itself if none)
+    static size_t tileableRunEnd(const CompiledPipeline& pipeline, size_t begin);
+
+    // halo needed so the tile cores of a run are exact: the sum of the neighbourhood radii
+    static int haloRadius(const CompiledPipeline& pipeline, size_t begin, size_t end);
+
+    // cover the image with tile_size x tile_size cores, padded by halo and clipped to the image
+    static std::vector<Tile> planTiles(cv::Size image_size, int tile_size, int halo);
+};
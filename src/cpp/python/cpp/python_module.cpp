@@ -0,0 +1,691 @@
+// python extension module `sea_vision` - runs pipelines in-process on buffer-protocol
+// arrays (numpy, memoryview, array.array, ...). inputs are wrapped by a cv::Mat header and
+// results are exported as buffers over the cv::Mat, so no pixels are copied at the boundary;
+// the gil is released while pixels are processed
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <opencv2/opencv.hpp>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include "../../bindings/hpp/operation_factory.hpp"
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "../../pipeline/hpp/image_loader.hpp"
+#include "../../pipeline/hpp/image_writer.hpp"
+#include "../../pipeline/hpp/pipeline_compiler.hpp"
+#include "../../pipeline/hpp/pipeline_executor.hpp"
+#include "../../pipeline/hpp/pipeline_optimizer.hpp"
+#include "../../pipeline/hpp/plan_cache.hpp"
+#include "../../runtime/hpp/scheduler.hpp"
+
+namespace {
+    // ---- pixel formats ----
+
+    // opencv depth of a struct-module format character, -1 if unsupported
+    int depthFromFormat(const char* format) {
+        if (!format) {
+            return CV_8U;
+        }
+        // native and little-endian markers (numpy uses '<' on some builds)
+        while (*format == '@' || *format == '=' || *format == '<') {
+            ++format;
+        }
+        if (format[0] == '\0' || format[1] != '\0') {
+            return -1;
+        }
+        switch (format[0]) {
+            case 'B': return CV_8U;
+            case 'b': return CV_8S;
+            case 'H': return CV_16U;
+            case 'h': return CV_16S;
+            case 'i': return CV_32S;
+            case 'f': return CV_32F;
+            case 'd': return CV_64F;
+            default: return -1;
+        }
+    }
+
+    const char* formatFromDepth(int depth) {
+        static const char* const formats[] = {"B", "b", "H", "h", "i", "f", "d"};
+        return depth >= CV_8U && depth <= CV_64F ? formats[depth] : nullptr;
+    }
+
+    // wrap a (height, width) or (height, width, channels) buffer in a mat header; pixels must
+    // be packed within a row, rows may be padded. false with a python error set otherwise
+    bool matFromBuffer(PyObject* object, bool writable, Py_buffer& view, cv::Mat& mat) {
+        int flags = PyBUF_STRIDES | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+        if (PyObject_GetBuffer(object, &view, flags) != 0) {
+            return false;
+        }
+
+        int depth = depthFromFormat(view.format);
+        int channels = view.ndim == 3 ? static_cast<int>(view.shape[2]) : 1;
+        bool valid = (view.ndim == 2 || view.ndim == 3) && depth >= 0 && channels >= 1 && channels <= 4
+            && view.itemsize == static_cast<Py_ssize_t>(CV_ELEM_SIZE1(depth)) && view.shape[0] > 0 && view.shape[1] > 0
+            && view.strides[1] == view.itemsize * channels && (view.ndim == 2 || view.strides[2] == view.itemsize)
+            && view.strides[0] >= view.strides[1] * view.shape[1];
+        if (!valid) {
+            PyBuffer_Release(&view);
+            PyErr_SetString(PyExc_ValueError,
+                            "image must be a (height, width[, 1-4 channels]) array of uint8, int8, uint16, int16, "
+                            "int32, float32 or float64 with pixels packed within each row");
+            return false;
+        }
+
+        mat = cv::Mat(static_cast<int>(view.shape[0]), static_cast<int>(view.shape[1]), CV_MAKETYPE(depth, channels),
+                      view.buf, static_cast<size_t>(view.strides[0]));
+        return true;
+    }
+
+    // run `work` without the gil; a c++ exception becomes a python RuntimeError
+    template <typename Work>
+    bool runWithoutGil(Work&& work) {
+        std::string error;
+        Py_BEGIN_ALLOW_THREADS
+        try {
+            work();
+        } catch (const std::exception& e) {
+            error = e.what();
+            if (error.empty()) {
+                error = "pipeline failed";
+            }
+        }
+        Py_END_ALLOW_THREADS
+        if (!error.empty()) {
+            PyErr_SetString(PyExc_RuntimeError, error.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // ---- Image: a cv::Mat exported through the buffer protocol ----
+
+    struct ImageObject {
+        PyObject_HEAD
+        cv::Mat* mat;
+        Py_buffer* source;   // input buffer the mat still points into, released with the image
+        bool readonly;       // the source is read-only (e.g. bytes), so the image is exported read-only too
+        Py_ssize_t shape[3];
+        Py_ssize_t strides[3];
+    };
+
+    extern PyTypeObject ImageType;
+
+    // image over a mat; `source` is the buffer the mat was computed from, kept only while the
+    // mat's pixels lie inside it (in-place runs and views), released otherwise
+    PyObject* makeImage(const cv::Mat& mat, Py_buffer* source) {
+        if (source) {
+            const char* begin = static_cast<const char*>(source->buf);
+            const char* data = reinterpret_cast<const char*>(mat.data);
+            if (data < begin || data >= begin + source->len) {
+                PyBuffer_Release(source);
+                delete source;
+                source = nullptr;
+            }
+        }
+
+        ImageObject* image = PyObject_New(ImageObject, &ImageType);
+        if (!image) {
+            if (source) {
+                PyBuffer_Release(source);
+                delete source;
+            }
+            return nullptr;
+        }
+        image->mat = new cv::Mat(mat);
+        image->source = source;
+        image->readonly = source && source->readonly;
+        image->shape[0] = mat.rows;
+        image->shape[1] = mat.cols;
+        image->shape[2] = mat.channels();
+        image->strides[0] = static_cast<Py_ssize_t>(mat.step[0]);
+        image->strides[1] = static_cast<Py_ssize_t>(mat.elemSize());
+        image->strides[2] = static_cast<Py_ssize_t>(mat.elemSize1());
+        return reinterpret_cast<PyObject*>(image);
+    }
+
+    void imageDealloc(ImageObject* self) {
+        delete self->mat;
+        if (self->source) {
+            PyBuffer_Release(self->source);
+            delete self->source;
+        }
+        PyObject_Free(self);
+    }
+
+    int imageGetBuffer(ImageObject* self, Py_buffer* view, int flags) {
+        const cv::Mat& mat = *self->mat;
+        if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES && !mat.isContinuous()) {
+            PyErr_SetString(PyExc_BufferError, "image rows are padded, a strided buffer is required");
+            view->obj = nullptr;
+            return -1;
+        }
+        if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && self->readonly) {
+            PyErr_SetString(PyExc_BufferError, "image shares the pixels of a read-only input");
+            view->obj = nullptr;
+            return -1;
+        }
+
+        view->buf = mat.data;
+        view->obj = reinterpret_cast<PyObject*>(self);
+        Py_INCREF(self);
+        view->len = static_cast<Py_ssize_t>(mat.total() * mat.elemSize());
+        view->readonly = self->readonly ? 1 : 0;
+        view->itemsize = static_cast<Py_ssize_t>(mat.elemSize1());
+        view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(formatFromDepth(mat.depth())) : nullptr;
+        view->ndim = mat.channels() == 1 ? 2 : 3;
+        view->shape = (flags & PyBUF_ND) ? self->shape : nullptr;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : nullptr;
+        view->suboffsets = nullptr;
+        view->internal = nullptr;
+        return 0;
+    }
+
+    PyBufferProcs image_buffer = {
+        reinterpret_cast<getbufferproc>(imageGetBuffer),
+        nullptr,
+    };
+
+    PyObject* imageWidth(ImageObject* self, void*) {
+        return PyLong_FromLong(self->mat->cols);
+    }
+
+    PyObject* imageHeight(ImageObject* self, void*) {
+        return PyLong_FromLong(self->mat->rows);
+    }
+
+    PyObject* imageChannels(ImageObject* self, void*) {
+        return PyLong_FromLong(self->mat->channels());
+    }
+
+    PyObject* imageFormat(ImageObject* self, void*) {
+        return PyUnicode_FromString(formatFromDepth(self->mat->depth()));
+    }
+
+    PyObject* imageShape(ImageObject* self, void*) {
+        if (self->mat->channels() == 1) {
+            return Py_BuildValue("(nn)", self->shape[0], self->shape[1]);
+        }
+        return Py_BuildValue("(nnn)", self->shape[0], self->shape[1], self->shape[2]);
+    }
+
+    PyObject* imageRepr(ImageObject* self) {
+        return PyUnicode_FromFormat("<sea_vision.Image %dx%d, %d channels, '%s'>", self->mat->cols, self->mat->rows,
+                                    self->mat->channels(), formatFromDepth(self->mat->depth()));
+    }
+
+    PyGetSetDef image_getset[] = {
+        {"width", reinterpret_cast<getter>(imageWidth), nullptr, "width in pixels", nullptr},
+        {"height", reinterpret_cast<getter>(imageHeight), nullptr, "height in pixels", nullptr},
+        {"channels", reinterpret_cast<getter>(imageChannels), nullptr, "channels per pixel", nullptr},
+        {"format", reinterpret_cast<getter>(imageFormat), nullptr, "struct format of one channel value", nullptr},
+        {"shape", reinterpret_cast<getter>(imageShape), nullptr, "(height, width[, channels])", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr},
+    };
+
+    // filled in by PyInit_sea_vision
+    PyTypeObject ImageType{};
+
+    // ---- Pipeline: a parsed pipeline compiled per input size ----
+
+    struct PipelineState {
+        std::string text;        // canonical json, the plan cache key
+        PipelineConfig config;
+        PlanCache plans;
+
+        PipelineState(std::string text, PipelineConfig config, bool optimize)
+            : text(std::move(text)), config(std::move(config)), plans(16, optimize) {}
+    };
+
+    struct PipelineObject {
+        PyObject_HEAD
+        // replaced by a re-run __init__ while other threads may still run the old one without
+        // the gil, so each run holds its own reference
+        std::shared_ptr<PipelineState> state;
+    };
+
+    extern PyTypeObject PipelineType;
+
+    // the python allocator only zeroes the object, the state's constructor runs here
+    PyObject* pipelineNew(PyTypeObject* type, PyObject*, PyObject*) {
+        PyObject* object = type->tp_alloc(type, 0);
+        if (object) {
+            new (&reinterpret_cast<PipelineObject*>(object)->state) std::shared_ptr<PipelineState>();
+        }
+        return object;
+    }
+
+    // parsed pipeline from a json document; false with a python error set
+    bool loadPipeline(PipelineObject* self, const nlohmann::json& document, bool optimize) {
+        try {
+            if (PipelineReader::isGraph(document)) {
+                throw std::runtime_error("pipeline graphs are not supported here, run each node as its own pipeline");
+            }
+            PipelineConfig config = PipelineReader::parsePipeline(document);
+            PipelineCompiler::validate(config);
+            self->state = std::make_shared<PipelineState>(document.dump(), std::move(config), optimize);
+            return true;
+        } catch (const std::exception& e) {
+            PyErr_SetString(PyExc_ValueError, e.what());
+            return false;
+        }
+    }
+
+    // json text of a dict (through the json module) or of a str as given
+    bool pipelineText(PyObject* pipeline, std::string& text) {
+        PyObject* encoded = nullptr;
+        if (PyDict_Check(pipeline)) {
+            PyObject* json_module = PyImport_ImportModule("json");
+            if (!json_module) {
+                return false;
+            }
+            encoded = PyObject_CallMethod(json_module, "dumps", "O", pipeline);
+            Py_DECREF(json_module);
+        } else if (PyUnicode_Check(pipeline)) {
+            encoded = pipeline;
+            Py_INCREF(encoded);
+        } else {
+            PyErr_SetString(PyExc_TypeError, "pipeline must be a dict or json text");
+            return false;
+        }
+        if (!encoded) {
+            return false;
+        }
+
+        Py_ssize_t length = 0;
+        const char* data = PyUnicode_AsUTF8AndSize(encoded, &length);
+        if (data) {
+            text.assign(data, static_cast<size_t>(length));
+        }
+        Py_DECREF(encoded);
+        return data != nullptr;
+    }
+
+    int pipelineInit(PipelineObject* self, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"pipeline", "optimize", nullptr};
+        PyObject* pipeline = nullptr;
+        int optimize = 1;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", const_cast<char**>(keywords), &pipeline, &optimize)) {
+            return -1;
+        }
+
+        std::string text;
+        if (!pipelineText(pipeline, text)) {
+            return -1;
+        }
+        nlohmann::json document = nlohmann::json::parse(text, nullptr, false);
+        if (document.is_discarded()) {
+            PyErr_SetString(PyExc_ValueError, "pipeline is not valid json");
+            return -1;
+        }
+        return loadPipeline(self, document, optimize != 0) ? 0 : -1;
+    }
+
+    void pipelineDealloc(PipelineObject* self) {
+        self->state.~shared_ptr<PipelineState>();
+        Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+    }
+
+    PyObject* pipelineFromFile(PyObject* type, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"path", "optimize", nullptr};
+        const char* path = nullptr;
+        int optimize = 1;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|p", const_cast<char**>(keywords), &path, &optimize)) {
+            return nullptr;
+        }
+
+        nlohmann::json document;
+        try {
+            document = PipelineReader::readJson(path);
+        } catch (const std::exception& e) {
+            PyErr_SetString(PyExc_ValueError, e.what());
+            return nullptr;
+        }
+
+        PyObject* object = pipelineNew(reinterpret_cast<PyTypeObject*>(type), nullptr, nullptr);
+        if (!object) {
+            return nullptr;
+        }
+        if (!loadPipeline(reinterpret_cast<PipelineObject*>(object), document, optimize != 0)) {
+            Py_DECREF(object);
+            return nullptr;
+        }
+        return object;
+    }
+
+    bool checkPipeline(PipelineObject* self) {
+        if (!self->state) {
+            PyErr_SetString(PyExc_RuntimeError, "pipeline is not initialized");
+            return false;
+        }
+        return true;
+    }
+
+    PyObject* pipelineRun(PipelineObject* self, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"image", "in_place", "region", nullptr};
+        PyObject* input = nullptr;
+        int in_place = 0;
+        PyObject* region_object = Py_None;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pO", const_cast<char**>(keywords), &input, &in_place,
+                                         &region_object)) {
+            return nullptr;
+        }
+        if (!checkPipeline(self)) {
+            return nullptr;
+        }
+
+        cv::Rect region;
+        if (region_object != Py_None
+            && !PyArg_ParseTuple(region_object, "iiii;region must be (x, y, width, height)", &region.x, &region.y,
+                                 &region.width, &region.height)) {
+            return nullptr;
+        }
+
+        auto view = std::make_unique<Py_buffer>();
+        cv::Mat image;
+        if (!matFromBuffer(input, in_place != 0, *view, image)) {
+            return nullptr;
+        }
+
+        std::shared_ptr<PipelineState> state = self->state;
+        cv::Mat result;
+        bool ran = runWithoutGil([&] {
+            // one executor per thread, so python threads run pipelines side by side
+            thread_local PipelineExecutor executor;
+            std::shared_ptr<const CompiledPipeline> plan = state->plans.get(state->text, image.size(), image.depth());
+            if (!region.empty()) {
+                result = executor.runRegion(*plan, image, region);
+            } else if (in_place) {
+                result = executor.runInPlace(*plan, image);
+            } else {
+                result = executor.run(*plan, image);
+            }
+        });
+        if (!ran) {
+            PyBuffer_Release(view.get());
+            return nullptr;
+        }
+        return makeImage(result, view.release());
+    }
+
+    PyObject* pipelineOutputShape(PipelineObject* self, PyObject* args) {
+        int width = 0;
+        int height = 0;
+        if (!PyArg_ParseTuple(args, "ii", &width, &height) || !checkPipeline(self)) {
+            return nullptr;
+        }
+        try {
+            cv::Size size = PipelineOptimizer::outputSize(self->state->config, cv::Size(width, height));
+            return Py_BuildValue("(ii)", size.height, size.width);
+        } catch (const std::exception& e) {
+            PyErr_SetString(PyExc_ValueError, e.what());
+            return nullptr;
+        }
+    }
+
+    PyObject* pipelineDescribe(PipelineObject* self, PyObject*) {
+        if (!checkPipeline(self)) {
+            return nullptr;
+        }
+        return PyUnicode_FromString(PipelineOptimizer::describe(self->state->config).c_str());
+    }
+
+    PyObject* pipelineOperations(PipelineObject* self, void*) {
+        if (!checkPipeline(self)) {
+            return nullptr;
+        }
+        const auto& operations = self->state->config.operations;
+        PyObject* list = PyList_New(static_cast<Py_ssize_t>(operations.size()));
+        for (size_t i = 0; list && i < operations.size(); ++i) {
+            PyObject* parameters = PyDict_New();
+            for (const auto& [name, value] : operations[i].parameters) {
+                PyObject* number = PyFloat_FromDouble(value);
+                PyDict_SetItemString(parameters, name.c_str(), number);
+                Py_XDECREF(number);
+            }
+            PyObject* operation = Py_BuildValue("{s:s,s:N}", "type", operations[i].type.c_str(), "parameters", parameters);
+            PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), operation);
+        }
+        return list;
+    }
+
+    PyMethodDef pipeline_methods[] = {
+        {"from_file", reinterpret_cast<PyCFunction>(reinterpret_cast<void*>(pipelineFromFile)),
+         METH_VARARGS | METH_KEYWORDS | METH_CLASS,
+         "from_file(path, optimize=True)\n--\n\nread a pipeline json file"},
+        {"run", reinterpret_cast<PyCFunction>(reinterpret_cast<void*>(pipelineRun)), METH_VARARGS | METH_KEYWORDS,
+         "run(image, in_place=False, region=None)\n--\n\n"
+         "run on a (height, width[, channels]) buffer and return the result as an Image, without copying at the\n"
+         "boundary. in_place lets the pipeline work in the (writable) input; region (x, y, width, height)\n"
+         "computes only that window of the output. the gil is released while pixels are processed"},
+        {"output_shape", reinterpret_cast<PyCFunction>(pipelineOutputShape), METH_VARARGS,
+         "output_shape(width, height)\n--\n\n(height, width) of the result for an input of this size"},
+        {"describe", reinterpret_cast<PyCFunction>(pipelineDescribe), METH_NOARGS,
+         "describe()\n--\n\nthe steps of the pipeline as text"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    PyGetSetDef pipeline_getset[] = {
+        {"operations", reinterpret_cast<getter>(pipelineOperations), nullptr, "operations as written", nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr},
+    };
+
+    // filled in by PyInit_sea_vision
+    PyTypeObject PipelineType{};
+
+    // ---- module functions ----
+
+    // roi from None (whole image) or (x, y, width, height)
+    bool parseROI(PyObject* object, ROI& roi) {
+        if (object == Py_None) {
+            roi = ROI(0, 0, 0, 0, true);
+            return true;
+        }
+        roi.full_image = false;
+        return PyArg_ParseTuple(object, "iiii;roi must be (x, y, width, height)", &roi.x, &roi.y, &roi.width,
+                                &roi.height) != 0;
+    }
+
+    PyObject* moduleExecute(PyObject*, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"operation", "image", "parameters", "roi", nullptr};
+        const char* type = nullptr;
+        PyObject* input = nullptr;
+        PyObject* parameters = nullptr;
+        PyObject* roi_object = Py_None;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sOO!|O", const_cast<char**>(keywords), &type, &input,
+                                         &PyDict_Type, &parameters, &roi_object)) {
+            return nullptr;
+        }
+
+        ROI roi;
+        if (!parseROI(roi_object, roi)) {
+            return nullptr;
+        }
+
+        std::map<std::string, double> params;
+        PyObject* key = nullptr;
+        PyObject* value = nullptr;
+        Py_ssize_t position = 0;
+        while (PyDict_Next(parameters, &position, &key, &value)) {
+            const char* name = PyUnicode_AsUTF8(key);
+            double number = PyFloat_AsDouble(value);
+            if (!name || (number == -1.0 && PyErr_Occurred())) {
+                return nullptr;
+            }
+            params[name] = number;
+        }
+
+        std::unique_ptr<Operation> operation = OperationFactory::createOperation(type);
+        if (!operation) {
+            PyErr_Format(PyExc_ValueError, "unknown operation type: %s", type);
+            return nullptr;
+        }
+
+        auto view = std::make_unique<Py_buffer>();
+        cv::Mat image;
+        if (!matFromBuffer(input, false, *view, image)) {
+            return nullptr;
+        }
+
+        cv::Mat result;
+        bool ran = runWithoutGil([&] {
+            result = operation->execute(image, roi, params);
+        });
+        if (!ran) {
+            PyBuffer_Release(view.get());
+            return nullptr;
+        }
+        return makeImage(result, view.release());
+    }
+
+    PyObject* moduleImread(PyObject*, PyObject* args) {
+        const char* path = nullptr;
+        if (!PyArg_ParseTuple(args, "s", &path)) {
+            return nullptr;
+        }
+
+        cv::Mat image;
+        std::string file(path);
+        if (!runWithoutGil([&] { ImageLoader::read(file, image); })) {
+            return nullptr;
+        }
+        if (image.empty()) {
+            PyErr_Format(PyExc_OSError, "could not load image '%s'", path);
+            return nullptr;
+        }
+        return makeImage(image, nullptr);
+    }
+
+    PyObject* moduleImwrite(PyObject*, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"path", "image", "jpeg_quality", "png_compression", "webp_quality", nullptr};
+        const char* path = nullptr;
+        PyObject* input = nullptr;
+        EncodeOptions encode;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|$iii", const_cast<char**>(keywords), &path, &input,
+                                         &encode.jpeg_quality, &encode.png_compression, &encode.webp_quality)) {
+            return nullptr;
+        }
+
+        Py_buffer view;
+        cv::Mat image;
+        if (!matFromBuffer(input, false, view, image)) {
+            return nullptr;
+        }
+
+        bool written = false;
+        std::string file(path);
+        bool ran = runWithoutGil([&] { written = ImageLoader::save(file, image, encode.params()); });
+        PyBuffer_Release(&view);
+        if (!ran) {
+            return nullptr;
+        }
+        if (!written) {
+            PyErr_Format(PyExc_OSError, "could not save image to '%s'", path);
+            return nullptr;
+        }
+        Py_RETURN_NONE;
+    }
+
+    PyObject* moduleOperations(PyObject*, PyObject*) {
+        std::vector<std::string> types = OperationFactory::availableOperations();
+        PyObject* list = PyList_New(static_cast<Py_ssize_t>(types.size()));
+        for (size_t i = 0; list && i < types.size(); ++i) {
+            PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), PyUnicode_FromString(types[i].c_str()));
+        }
+        return list;
+    }
+
+    PyObject* moduleSetThreads(PyObject*, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"threads", "workers", nullptr};
+        Py_ssize_t threads = 0;
+        Py_ssize_t workers = 1;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", const_cast<char**>(keywords), &threads, &workers)) {
+            return nullptr;
+        }
+        if (threads < 0 || workers < 1) {
+            PyErr_SetString(PyExc_ValueError, "threads must be >= 0 and workers >= 1");
+            return nullptr;
+        }
+
+        Scheduler::shared().setThreadBudget(static_cast<size_t>(threads));
+        SchedulePlan split = Scheduler::shared().plan(static_cast<size_t>(workers), static_cast<size_t>(workers));
+        return PyLong_FromLong(split.intra_threads);
+    }
+
+    PyMethodDef module_methods[] = {
+        {"execute", reinterpret_cast<PyCFunction>(reinterpret_cast<void*>(moduleExecute)), METH_VARARGS | METH_KEYWORDS,
+         "execute(operation, image, parameters, roi=None)\n--\n\n"
+         "run a single operation (e.g. 'blur', {'kernel_size': 5, 'sigma': 1.0}) on an image, roi as (x, y, width, height)"},
+        {"imread", reinterpret_cast<PyCFunction>(moduleImread), METH_VARARGS,
+         "imread(path)\n--\n\ndecode an image, or map a .svraw file without decoding"},
+        {"imwrite", reinterpret_cast<PyCFunction>(reinterpret_cast<void*>(moduleImwrite)), METH_VARARGS | METH_KEYWORDS,
+         "imwrite(path, image, *, jpeg_quality=-1, png_compression=-1, webp_quality=-1)\n--\n\n"
+         "encode an image by extension (-1 keeps the format's default), .svraw files are written uncompressed"},
+        {"operations", reinterpret_cast<PyCFunction>(moduleOperations), METH_NOARGS,
+         "operations()\n--\n\nnames of the available operation types"},
+        {"set_threads", reinterpret_cast<PyCFunction>(reinterpret_cast<void*>(moduleSetThreads)),
+         METH_VARARGS | METH_KEYWORDS,
+         "set_threads(threads=0, workers=1)\n--\n\n"
+         "set the thread budget (0: one per core) shared by `workers` python threads running pipelines at\n"
+         "the same time; returns the opencv threads each of them gets"},
+        {nullptr, nullptr, 0, nullptr},
+    };
+
+    // filled in by PyInit_sea_vision
+    PyModuleDef module_def{};
+}
+
+PyMODINIT_FUNC PyInit_sea_vision() {
+    // static objects start with one reference and no type, as PyVarObject_HEAD_INIT sets them
+    const PyVarObject type_head = {PyObject_HEAD_INIT(nullptr) 0};
+
+    ImageType.ob_base = type_head;
+    ImageType.tp_name = "sea_vision.Image";
+    ImageType.tp_basicsize = sizeof(ImageObject);
+    ImageType.tp_dealloc = reinterpret_cast<destructor>(imageDealloc);
+    ImageType.tp_repr = reinterpret_cast<reprfunc>(imageRepr);
+    ImageType.tp_as_buffer = &image_buffer;
+    ImageType.tp_flags = Py_TPFLAGS_DEFAULT;
+    ImageType.tp_doc = "pipeline result, readable through the buffer protocol (e.g. numpy.asarray); writable unless "
+                       "it shares the pixels of a read-only input";
+    ImageType.tp_getset = image_getset;
+
+    PipelineType.ob_base = type_head;
+    PipelineType.tp_name = "sea_vision.Pipeline";
+    PipelineType.tp_basicsize = sizeof(PipelineObject);
+    PipelineType.tp_dealloc = reinterpret_cast<destructor>(pipelineDealloc);
+    PipelineType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+    PipelineType.tp_doc = "Pipeline(pipeline, optimize=True)\n--\n\n"
+                          "parsed pipeline (dict or json text), compiled once per input size";
+    PipelineType.tp_methods = pipeline_methods;
+    PipelineType.tp_getset = pipeline_getset;
+    PipelineType.tp_init = reinterpret_cast<initproc>(pipelineInit);
+    PipelineType.tp_new = reinterpret_cast<newfunc>(pipelineNew);
+
+    module_def.m_base = PyModuleDef_HEAD_INIT;
+    module_def.m_name = "sea_vision";
+    module_def.m_doc = "in-process sea vision pipelines on buffer-protocol images (numpy arrays, memoryviews, ...)";
+    module_def.m_size = -1;
+    module_def.m_methods = module_methods;
+
+    if (PyType_Ready(&ImageType) < 0 || PyType_Ready(&PipelineType) < 0) {
+        return nullptr;
+    }
+
+    PyObject* module = PyModule_Create(&module_def);
+    if (!module) {
+        return nullptr;
+    }
+    Py_INCREF(&ImageType);
+    Py_INCREF(&PipelineType);
+    if (PyModule_AddObject(module, "Image", reinterpret_cast<PyObject*>(&ImageType)) < 0
+        || PyModule_AddObject(module, "Pipeline", reinterpret_cast<PyObject*>(&PipelineType)) < 0) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
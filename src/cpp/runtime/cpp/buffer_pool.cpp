@@ -0,0 +1,95 @@
+#include "../hpp/buffer_pool.hpp"
+
+namespace {
+    thread_local BufferPool* current_pool = nullptr;
+}
+
+BufferPool::BufferPool(size_t max_cached_bytes)
+    : max_cached_bytes(max_cached_bytes) {}
+
+cv::Mat BufferPool::acquire(cv::Size size, int type) {
+    for (auto it = idle.begin(); it != idle.end(); ++it) {
+        if (it->size() == size && it->type() == type) {
+            cv::Mat buffer = *it;
+            cached_bytes -= byteSize(buffer);
+            idle.erase(it);
+            ++reuses;
+            return buffer;
+        }
+    }
+
+    ++allocations;
+    return cv::Mat(size, type);
+}
+
+void BufferPool::release(cv::Mat& buffer) {
+    // only whole allocations nobody else is looking at
+    if (buffer.empty() || buffer.dims != 2 || buffer.isSubmatrix() || !buffer.u || buffer.u->refcount != 1) {
+        buffer.release();
+        return;
+    }
+
+    size_t bytes = byteSize(buffer);
+    if (bytes > max_cached_bytes) {
+        buffer.release();
+        return;
+    }
+
+    idle.push_back(buffer);
+    cached_bytes += bytes;
+    buffer.release();
+
+    while (cached_bytes > max_cached_bytes) {
+        cached_bytes -= byteSize(idle.front());
+        idle.pop_front();
+    }
+}
+
+void BufferPool::clear() {
+    idle.clear();
+    cached_bytes = 0;
+}
+
+size_t BufferPool::allocationCount() const {
+    return allocations;
+}
+
+size_t BufferPool::reuseCount() const {
+    return reuses;
+}
+
+size_t BufferPool::cachedBytes() const {
+    return cached_bytes;
+}
+
+size_t BufferPool::byteSize(const cv::Mat& buffer) {
+    return buffer.total() * buffer.elemSize();
+}
+
+BufferPool::Scope::Scope(BufferPool& pool)
+    : previous(current_pool) {
+    current_pool = &pool;
+}
+
+BufferPool::Scope::~Scope() {
+    current_pool = previous;
+}
+
+BufferPool* BufferPool::current() {
+    return current_pool;
+}
+
+cv::Mat BufferPool::acquireScratch(cv::Size size, int type) {
+    if (current_pool) {
+        return current_pool->acquire(size, type);
+    }
+    return cv::Mat(size, type);
+}
+
+void BufferPool::releaseScratch(cv::Mat& buffer) {
+    if (current_pool) {
+        current_pool->release(buffer);
+    } else {
+        buffer.release();
+    }
+}
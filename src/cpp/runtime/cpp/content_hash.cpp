@@ -0,0 +1,132 @@
+#include "../hpp/content_hash.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    const uint32_t sha256_rounds[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    uint32_t rotr(uint32_t value, int bits) {
+        return (value >> bits) | (value << (32 - bits));
+    }
+}
+
+uint64_t ContentHash::fnv1a(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t value = seed;
+    for (size_t i = 0; i < size; ++i) {
+        value ^= bytes[i];
+        value *= 0x100000001b3ULL;
+    }
+    return value;
+}
+
+uint64_t ContentHash::fnv1a(const std::string& text, uint64_t seed) {
+    return fnv1a(text.data(), text.size(), seed);
+}
+
+std::string ContentHash::hex(uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << value;
+    return out.str();
+}
+
+ContentHash::Sha256::Sha256()
+    : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+void ContentHash::Sha256::update(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    length += size;
+
+    // top up a partial block first, then take whole blocks straight from the input
+    if (used > 0) {
+        size_t taken = std::min(size, sizeof(block) - used);
+        std::memcpy(block + used, bytes, taken);
+        used += taken;
+        bytes += taken;
+        size -= taken;
+        if (used < sizeof(block)) {
+            return;
+        }
+        compress(block);
+        used = 0;
+    }
+    for (; size >= sizeof(block); bytes += sizeof(block), size -= sizeof(block)) {
+        compress(bytes);
+    }
+    std::memcpy(block, bytes, size);
+    used = size;
+}
+
+void ContentHash::Sha256::update(const std::string& text) {
+    update(text.data(), text.size());
+}
+
+std::string ContentHash::Sha256::hexDigest() {
+    // a single 1 bit, zeros up to 56 bytes into a block, then the length in bits big-endian
+    uint64_t bits = length * 8;
+    unsigned char padding[72] = {0x80};
+    size_t pad = (used < 56 ? 56 : 120) - used;
+    for (int i = 0; i < 8; ++i) {
+        padding[pad + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+    }
+    update(padding, pad + 8);
+
+    std::ostringstream out;
+    out << std::hex << std::setfill('0');
+    for (uint32_t word : state) {
+        out << std::setw(8) << word;
+    }
+    return out.str();
+}
+
+void ContentHash::Sha256::compress(const unsigned char* data) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = uint32_t(data[4 * i]) << 24 | uint32_t(data[4 * i + 1]) << 16 | uint32_t(data[4 * i + 2]) << 8
+               | uint32_t(data[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256_rounds[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+std::string ContentHash::sha256(const std::string& text) {
+    Sha256 hash;
+    hash.update(text);
+    return hash.hexDigest();
+}
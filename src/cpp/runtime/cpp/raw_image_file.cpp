@@ -0,0 +1,233 @@
+#include "../hpp/raw_image_file.hpp"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char raw_magic[8] = {'S', 'V', 'R', 'A', 'W', 'I', 'M', 'G'};
+
+    // header and pixels are mapped as they are, with no byte swapping
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr bool little_endian_host = false;
+#else
+    constexpr bool little_endian_host = true;
+#endif
+
+    bool checkHost(const std::string& path) {
+        if (!little_endian_host) {
+            std::cerr << "error: raw image '" << path << "' is little-endian, this host is not" << std::endl;
+        }
+        return little_endian_host;
+    }
+
+    // what a mapped mat keeps alive
+    struct Mapping {
+        void* address = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        HANDLE file_mapping = nullptr;
+#endif
+    };
+
+    void releaseMapping(Mapping* mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping->address);
+        CloseHandle(mapping->file_mapping);
+#else
+        ::munmap(mapping->address, mapping->length);
+#endif
+        delete mapping;
+    }
+
+    // allocator of mats whose pixels live in a file mapping: it never hands out memory of its
+    // own, it only unmaps once the last mat referring to the mapping is released
+    class MappingAllocator : public cv::MatAllocator {
+    public:
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                               cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+        }
+
+        bool allocate(cv::UMatData* data, cv::AccessFlag, cv::UMatUsageFlags) const override {
+            return data != nullptr;
+        }
+
+        void deallocate(cv::UMatData* data) const override {
+            if (data) {
+                releaseMapping(static_cast<Mapping*>(data->userdata));
+                delete data;
+            }
+        }
+    };
+
+    const MappingAllocator mapping_allocator;
+}
+
+bool RawImageFile::isRawPath(const std::string& path) {
+    return fs::path(path).extension() == extension;
+}
+
+cv::Mat RawImageFile::map(const std::string& path) {
+    if (!checkHost(path)) {
+        return cv::Mat();
+    }
+    std::ifstream file(path, std::ios::binary);
+    RawImageHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "error: could not read raw image header from '" << path << "'" << std::endl;
+        return cv::Mat();
+    }
+    file.close();
+
+    // everything the mat header is built from has to be consistent with the file: sizes fit
+    // an int, rows are packed, and the pixel area's end neither overflows nor passes the file
+    const int type = static_cast<int>(header.type);
+    const uint64_t pixel_size = CV_ELEM_SIZE(type);
+    const uint64_t max_side = static_cast<uint64_t>(std::numeric_limits<int>::max());
+    std::error_code error;
+    const uintmax_t file_size = fs::file_size(path, error);
+    bool valid = std::memcmp(header.magic, raw_magic, sizeof(raw_magic)) == 0 && header.version == 1
+        && header.data_offset >= sizeof(header) && CV_MAT_DEPTH(type) <= CV_16F && CV_MAT_CN(type) <= 4
+        && (type & ~CV_MAT_TYPE_MASK) == 0 && header.width > 0 && header.height > 0
+        && header.width <= max_side && header.height <= max_side
+        && header.row_stride == header.width * pixel_size
+        && header.height <= (std::numeric_limits<size_t>::max() - header.data_offset) / header.row_stride
+        && header.data_size == header.row_stride * header.height
+        && !error && file_size >= header.data_offset + header.data_size;
+    if (!valid) {
+        std::cerr << "error: '" << path << "' is not a valid raw image" << std::endl;
+        return cv::Mat();
+    }
+
+    return mapFile(path, header.data_offset + header.data_size, false, header);
+}
+
+cv::Mat RawImageFile::create(const std::string& path, cv::Size size, int type) {
+    RawImageHeader header{};
+    std::memcpy(header.magic, raw_magic, sizeof(raw_magic));
+    header.version = 1;
+    header.data_offset = data_offset;
+    header.width = static_cast<uint32_t>(size.width);
+    header.height = static_cast<uint32_t>(size.height);
+    header.type = static_cast<uint32_t>(type);
+    header.row_stride = static_cast<uint64_t>(size.width) * CV_ELEM_SIZE(type);
+    header.data_size = header.row_stride * header.height;
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header))) {
+            std::cerr << "error: could not create raw image '" << path << "'" << std::endl;
+            return cv::Mat();
+        }
+    }
+
+    // the pixel area is sized up front and filled through the mapping
+    std::error_code error;
+    fs::resize_file(path, header.data_offset + header.data_size, error);
+    if (error) {
+        std::cerr << "error: could not size raw image '" << path << "': " << error.message() << std::endl;
+        return cv::Mat();
+    }
+
+    return mapFile(path, header.data_offset + header.data_size, true, header);
+}
+
+bool RawImageFile::write(const std::string& path, const cv::Mat& image) {
+    if (image.empty() || image.dims != 2 || !checkHost(path)) {
+        return false;
+    }
+
+    // filled under a private name in the same directory, then renamed over the target: the
+    // target may be the input, still mapped, whose pages must not be truncated underneath it
+    static std::atomic<uint64_t> sequence{0};
+    fs::path target(path);
+    fs::path temporary = target.parent_path()
+        / ("." + target.filename().string() + "-" + std::to_string(processId()) + "-" + std::to_string(sequence++));
+
+    cv::Mat mapped = create(temporary.string(), image.size(), image.type());
+    std::error_code error;
+    if (mapped.empty()) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    image.copyTo(mapped);
+    mapped.release();
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        std::cerr << "error: could not replace raw image '" << path << "': " << error.message() << std::endl;
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+long RawImageFile::processId() {
+#ifdef _WIN32
+    return static_cast<long>(GetCurrentProcessId());
+#else
+    return static_cast<long>(::getpid());
+#endif
+}
+
+cv::Mat RawImageFile::mapFile(const std::string& path, size_t length, bool shared, const RawImageHeader& header) {
+    auto mapping = new Mapping();
+    mapping->length = length;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), shared ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        mapping->file_mapping = CreateFileMappingA(file, nullptr, shared ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+    }
+    if (mapping->file_mapping) {
+        mapping->address = MapViewOfFile(mapping->file_mapping, shared ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, length);
+        if (!mapping->address) {
+            CloseHandle(mapping->file_mapping);
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+    if (fd >= 0) {
+        // private mappings are copy-on-write, so a read-only file still gives a writable mat
+        void* address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        mapping->address = address == MAP_FAILED ? nullptr : address;
+        ::close(fd);
+    }
+#endif
+
+    if (!mapping->address) {
+        std::cerr << "error: could not map raw image '" << path << "'" << std::endl;
+        delete mapping;
+        return cv::Mat();
+    }
+
+    // a mat over the pixels that owns the mapping through its allocator
+    uchar* pixels = static_cast<uchar*>(mapping->address) + header.data_offset;
+    cv::Mat image(static_cast<int>(header.height), static_cast<int>(header.width), static_cast<int>(header.type),
+                  pixels, static_cast<size_t>(header.row_stride));
+
+    cv::UMatData* data = new cv::UMatData(&mapping_allocator);
+    data->data = pixels;
+    data->origdata = pixels;
+    data->size = header.data_size;
+    data->flags = cv::UMatData::USER_ALLOCATED;
+    data->userdata = mapping;
+    data->refcount = 1;
+    image.u = data;
+    return image;
+}
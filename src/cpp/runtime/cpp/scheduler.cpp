@@ -0,0 +1,52 @@
+#include "../hpp/scheduler.hpp"
+#include "../hpp/thread_pool.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+
+Scheduler& Scheduler::shared() {
+    static Scheduler scheduler;
+    return scheduler;
+}
+
+Scheduler::Scheduler() : budget(ThreadPool::defaultThreadCount()) {
+    active.intra_threads = static_cast<int>(budget);
+}
+
+void Scheduler::setThreadBudget(size_t threads) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = threads == 0 ? ThreadPool::defaultThreadCount() : threads;
+}
+
+size_t Scheduler::threadBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget;
+}
+
+SchedulePlan Scheduler::plan(size_t frames, size_t max_workers, size_t reserved) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // the fixed stages run regardless, the frame work gets at least one thread
+    size_t available = budget > reserved ? budget - reserved : 1;
+
+    size_t workers = available;
+    if (frames > 0) {
+        workers = std::min(workers, frames);
+    }
+    if (max_workers > 0) {
+        workers = std::min(workers, max_workers);
+    }
+
+    SchedulePlan split;
+    split.frame_workers = std::max<size_t>(1, workers);
+    split.intra_threads = static_cast<int>(std::max<size_t>(1, available / split.frame_workers));
+
+    // opencv treats 1 as "run sequentially", so nested loops inside busy workers stay on their thread
+    cv::setNumThreads(split.intra_threads);
+    active = split;
+    return split;
+}
+
+SchedulePlan Scheduler::current() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active;
+}
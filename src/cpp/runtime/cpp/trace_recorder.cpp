@@ -0,0 +1,198 @@
+#include "../hpp/trace_recorder.hpp"
+#include "../../../../include/json-develop/single_include/nlohmann/json.hpp"
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+    thread_local TraceRecorder* current_recorder = nullptr;
+    thread_local int current_step = -1;
+    thread_local int current_tile = -1;
+
+    // bytes of cv::Mat data allocated by this thread since it started
+    thread_local size_t thread_allocated = 0;
+
+    // forwards to opencv's standard allocator and counts what it hands out
+    class CountingAllocator : public cv::MatAllocator {
+    public:
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                               cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+            cv::UMatData* u = cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+            // caller-supplied data is wrapped, not allocated
+            if (u && !data) {
+                thread_allocated += u->size;
+            }
+            return u;
+        }
+
+        bool allocate(cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+            return cv::Mat::getStdAllocator()->allocate(data, flags, usage);
+        }
+
+        // never reached: the standard allocator owns (and frees) what it allocated
+        void deallocate(cv::UMatData* data) const override {
+            cv::Mat::getStdAllocator()->deallocate(data);
+        }
+    };
+
+    double threadCpuMicroseconds() {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+            return 0.0;
+        }
+        auto ticks = [](const FILETIME& t) {
+            return (static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+        };
+        // 100 ns units
+        return (ticks(kernel) + ticks(user)) / 10.0;
+#else
+        timespec now;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) {
+            return 0.0;
+        }
+        return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+#endif
+    }
+
+    std::string describeShape(const TraceShape& shape) {
+        return std::to_string(shape.size.width) + "x" + std::to_string(shape.size.height) + "x" + std::to_string(shape.channels);
+    }
+
+    nlohmann::json eventToJson(const TraceEvent& event) {
+        return {
+            {"operation", event.operation},
+            {"phase", event.phase},
+            {"step", event.step},
+            {"tile", event.tile},
+            {"thread", event.thread},
+            {"start_us", event.start_us},
+            {"wall_us", event.wall_us},
+            {"cpu_us", event.cpu_us},
+            {"bytes_allocated", event.bytes_allocated},
+            {"input", describeShape(event.input)},
+            {"output", describeShape(event.output)}
+        };
+    }
+}
+
+TraceRecorder::TraceRecorder()
+    : origin(Clock::now()) {
+    installAllocationCounter();
+}
+
+TraceRecorder::Mark TraceRecorder::mark() {
+    Mark m;
+    m.wall = Clock::now();
+    m.cpu_us = threadCpuMicroseconds();
+    m.allocated = thread_allocated;
+    return m;
+}
+
+void TraceRecorder::record(const std::string& operation, const std::string& phase, const Mark& begin,
+                           const TraceShape& input, const TraceShape& output) {
+    Mark end = mark();
+
+    TraceEvent event;
+    event.operation = operation;
+    event.phase = phase;
+    event.step = current_step;
+    event.tile = current_tile;
+    event.start_us = std::chrono::duration<double, std::micro>(begin.wall - origin).count();
+    event.wall_us = std::chrono::duration<double, std::micro>(end.wall - begin.wall).count();
+    event.cpu_us = end.cpu_us - begin.cpu_us;
+    event.bytes_allocated = end.allocated - begin.allocated;
+    event.input = input;
+    event.output = output;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = thread_numbers.emplace(std::this_thread::get_id(), static_cast<int>(thread_numbers.size())).first;
+    event.thread = it->second;
+    recorded.push_back(std::move(event));
+}
+
+std::vector<TraceEvent> TraceRecorder::events() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+
+void TraceRecorder::writeJsonLines(std::ostream& out) const {
+    for (const auto& event : events()) {
+        out << eventToJson(event).dump() << "\n";
+    }
+}
+
+void TraceRecorder::writeChromeTrace(std::ostream& out) const {
+    nlohmann::json trace_events = nlohmann::json::array();
+    for (const auto& event : events()) {
+        nlohmann::json args = eventToJson(event);
+        args.erase("operation");
+        args.erase("phase");
+        args.erase("thread");
+        args.erase("start_us");
+        args.erase("wall_us");
+
+        // complete ("X") events nest by time, so phases show up under their step
+        trace_events.push_back({
+            {"name", event.phase == "step" ? event.operation : event.operation + " " + event.phase},
+            {"cat", event.phase},
+            {"ph", "X"},
+            {"ts", event.start_us},
+            {"dur", event.wall_us},
+            {"pid", 1},
+            {"tid", event.thread},
+            {"args", args}
+        });
+    }
+
+    nlohmann::json document;
+    document["traceEvents"] = trace_events;
+    document["displayTimeUnit"] = "ms";
+    out << document.dump() << "\n";
+}
+
+bool TraceRecorder::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    bool json_lines = path.size() >= 6 && path.compare(path.size() - 6, 6, ".jsonl") == 0;
+    if (json_lines) {
+        writeJsonLines(out);
+    } else {
+        writeChromeTrace(out);
+    }
+    return static_cast<bool>(out);
+}
+
+TraceRecorder::Scope::Scope(TraceRecorder* recorder, int step, int tile)
+    : previous(current_recorder), previous_step(current_step), previous_tile(current_tile) {
+    if (recorder) {
+        current_recorder = recorder;
+    }
+    current_step = step;
+    current_tile = tile;
+}
+
+TraceRecorder::Scope::~Scope() {
+    current_recorder = previous;
+    current_step = previous_step;
+    current_tile = previous_tile;
+}
+
+TraceRecorder* TraceRecorder::current() {
+    return current_recorder;
+}
+
+void TraceRecorder::installAllocationCounter() {
+    // the allocator lives for the whole process, buffers allocated through it may outlive any recorder
+    static CountingAllocator allocator;
+    static std::once_flag installed;
+    std::call_once(installed, [] { cv::Mat::setDefaultAllocator(&allocator); });
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// fixed-capacity blocking queue between pipeline stages; it records how long
+// producers waited on a full queue (backpressure from downstream) and how long
+// consumers waited on an empty one (starved by upstream)
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity(capacity == 0 ? 1 : capacity) {}
+
+    // block while full; false if the queue was closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.size() >= capacity && !closed) {
+            auto start = std::chrono::steady_clock::now();
+            not_full.wait(lock, [this] { return items.size() < capacity || closed; });
+            push_wait += std::chrono::steady_clock::now() - start;
+        }
+        if (closed) {
+            return false;
+        }
+
+        items.push_back(std::move(item));
+        if (items.size() > max_depth) {
+            max_depth = items.size();
+        }
+        not_empty.notify_one();
+        return true;
+    }
+
+    // block while empty; false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.empty() && !closed) {
+            auto start = std::chrono::steady_clock::now();
+            not_empty.wait(lock, [this] { return !items.empty() || closed; });
+            pop_wait += std::chrono::steady_clock::now() - start;
+        }
+        if (items.empty()) {
+            return false;
+        }
+
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // no more items will be pushed; consumers drain what is left
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    // seconds producers spent blocked on a full queue
+    double pushWaitSeconds() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::chrono::duration<double>(push_wait).count();
+    }
+
+    // seconds consumers spent blocked on an empty queue
+    double popWaitSeconds() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::chrono::duration<double>(pop_wait).count();
+    }
+
+    // deepest the queue has been
+    size_t maxDepth() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return max_depth;
+    }
+
+private:
+    const size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+    std::chrono::steady_clock::duration push_wait{0};
+    std::chrono::steady_clock::duration pop_wait{0};
+    size_t max_depth = 0;
+};
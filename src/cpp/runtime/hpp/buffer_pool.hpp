@@ -0,0 +1,61 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <deque>
+
+// recycles size- and type-matched image buffers between pipeline steps and
+// across frames, so a steady-state frame loop allocates nothing; a pool is
+// owned by one executor and is not shared between threads
+class BufferPool {
+public:
+    // keep at most max_cached_bytes of idle buffers (oldest dropped first)
+    explicit BufferPool(size_t max_cached_bytes = size_t(1) << 30);
+
+    // get a buffer with exactly this size and type, reusing an idle one when possible
+    cv::Mat acquire(cv::Size size, int type);
+
+    // hand a buffer back for reuse; ignored unless the caller holds the only reference
+    // to a whole (non-roi) allocation, so live data is never recycled
+    void release(cv::Mat& buffer);
+
+    // drop every idle buffer
+    void clear();
+
+    // number of fresh allocations and reuses since construction
+    size_t allocationCount() const;
+    size_t reuseCount() const;
+
+    // bytes currently held by idle buffers
+    size_t cachedBytes() const;
+
+    // makes a pool the current one on this thread for as long as the scope lives
+    class Scope {
+    public:
+        explicit Scope(BufferPool& pool);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        BufferPool* previous;
+    };
+
+    // pool made current on this thread by a Scope, or nullptr
+    static BufferPool* current();
+
+    // acquire from the current pool, or allocate when no pool is active
+    static cv::Mat acquireScratch(cv::Size size, int type);
+
+    // release to the current pool, or just drop the reference when no pool is active
+    static void releaseScratch(cv::Mat& buffer);
+
+private:
+    std::deque<cv::Mat> idle;
+    size_t max_cached_bytes;
+    size_t cached_bytes = 0;
+    size_t allocations = 0;
+    size_t reuses = 0;
+
+    static size_t byteSize(const cv::Mat& buffer);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// hashes of inputs and pipeline text shared by the plan, step and result caches: fnv-1a
+// where a key is checked against its text or only lives in memory, sha-256 where an entry
+// is found by its digest alone
+class ContentHash {
+public:
+    // offset basis of 64-bit fnv-1a; pass an earlier hash as the seed to continue it
+    static constexpr uint64_t fnv_basis = 0xcbf29ce484222325ULL;
+
+    // 64-bit fnv-1a of a block of bytes, e.g. an encoded input
+    static uint64_t fnv1a(const void* data, size_t size, uint64_t seed = fnv_basis);
+    static uint64_t fnv1a(const std::string& text, uint64_t seed = fnv_basis);
+
+    // the value as 16 lowercase hex digits
+    static std::string hex(uint64_t value);
+
+    // sha-256 of data fed in pieces
+    class Sha256 {
+    public:
+        Sha256();
+
+        void update(const void* data, size_t size);
+        void update(const std::string& text);
+
+        // the digest as 64 lowercase hex digits; no more data may follow
+        std::string hexDigest();
+
+    private:
+        uint32_t state[8];
+        unsigned char block[64];
+        size_t used = 0;       // bytes waiting in block
+        uint64_t length = 0;   // bytes fed so far
+
+        void compress(const unsigned char* data);
+    };
+
+    // sha-256 of the text as 64 lowercase hex digits
+    static std::string sha256(const std::string& text);
+};
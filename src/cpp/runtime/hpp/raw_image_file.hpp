@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+
+/**
+ * header at the start of a raw image file; the pixel rows follow at data_offset, a page
+ * boundary, tightly packed in opencv's interleaved layout. all values are little-endian;
+ * files are mapped without conversion, so big-endian hosts refuse to read or write them
+ */
+struct RawImageHeader {
+    char magic[8];          // "SVRAWIMG"
+    uint32_t version;       // 1
+    uint32_t data_offset;   // 4096
+    uint32_t width;
+    uint32_t height;
+    uint32_t type;          // opencv type, depth and channels (e.g. CV_8UC3 = 16)
+    uint32_t reserved;
+    uint64_t row_stride;    // bytes per row, exactly width * pixel size
+    uint64_t data_size;     // row_stride * height
+};
+
+// raw image file class - uncompressed images behind a memory mapping. reading points a
+// cv::Mat straight into the mapped file, so nothing is decoded or copied; the mat owns the
+// mapping and unmaps it when its last reference goes. writing maps the new file and copies
+// the rows in once, with no encoding
+class RawImageFile {
+public:
+    // file extension that selects the raw format
+    static constexpr const char* extension = ".svraw";
+
+    // true if the path has the raw extension
+    static bool isRawPath(const std::string& path);
+
+    // map a raw file copy-on-write: in-place steps may write to the mat, the file stays
+    // unchanged. returns an empty mat (and reports why) if the file is missing or malformed
+    static cv::Mat map(const std::string& path);
+
+    // create (or truncate) a raw file for an image of the given size and type and map it
+    // shared: whatever is written into the returned mat ends up in the file. the path must
+    // not be mapped elsewhere, truncating it would pull the pages from under that mapping
+    static cv::Mat create(const std::string& path, cv::Size size, int type);
+
+    // write an image to a raw file through a shared mapping of a temporary file, renamed over
+    // the path once complete; safe when the path is the (mapped) input of the same run
+    static bool write(const std::string& path, const cv::Mat& image);
+
+private:
+    // page-aligned start of the pixel data
+    static constexpr uint32_t data_offset = 4096;
+
+    // id of this process, part of temporary file names
+    static long processId();
+
+    // map `length` bytes of a file; shared mappings write through to the file
+    static cv::Mat mapFile(const std::string& path, size_t length, bool shared, const RawImageHeader& header);
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+/**
+ * one split of the thread budget between frames and the work inside a frame
+ */
+struct SchedulePlan {
+    size_t frame_workers = 1;   // frames processed at the same time
+    int intra_threads = 1;      // threads opencv's parallel loops (tiles, row bands) may use per frame
+};
+
+// scheduler class - one process-wide thread budget shared by frame-level workers and
+// opencv's own parallel loops. applying a plan sets opencv's thread count, so workers
+// that each run multi-threaded opencv calls never multiply past the budget
+class Scheduler {
+public:
+    // the process-wide scheduler
+    static Scheduler& shared();
+
+    // total threads to use; 0 restores the default of one per hardware thread
+    void setThreadBudget(size_t threads);
+    size_t threadBudget() const;
+
+    // split the budget for `frames` independent frames (0 if unknown) with at most
+    // `max_workers` frame workers (0 for no cap), keeping `reserved` threads for fixed
+    // stages such as video decode and encode, and apply it to opencv.
+    // frames come first: each worker keeps a whole core busy without synchronisation,
+    // and what is left over is spread across the frames as intra-frame threads
+    SchedulePlan plan(size_t frames, size_t max_workers = 0, size_t reserved = 0);
+
+    // the plan applied last (single frame, whole budget until the first call)
+    SchedulePlan current() const;
+
+private:
+    Scheduler();
+
+    mutable std::mutex mutex;
+    size_t budget;
+    SchedulePlan active;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// work-stealing thread pool: every worker owns a task deque, pops its own
+// work from the back and steals from the front of the others when idle
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // start the given number of workers (at least one)
+    explicit ThreadPool(size_t num_threads);
+
+    // finish queued work and join all workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // queue a task, spreading submissions across worker deques
+    void submit(Task task);
+
+    // block until every submitted task has finished
+    void wait();
+
+    // number of worker threads
+    size_t size() const;
+
+    // sensible default worker count for this machine
+    static size_t defaultThreadCount();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    size_t queued = 0;
+    size_t unfinished = 0;
+    bool stopping = false;
+
+    std::atomic<size_t> next_queue{0};
+
+    // main loop of worker thread `index`
+    void workerLoop(size_t index);
+
+    // take a task from the worker's own deque, or steal one from another
+    bool takeTask(size_t index, Task& task);
+};
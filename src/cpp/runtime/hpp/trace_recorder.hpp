@@ -0,0 +1,104 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * dimensions of an image seen by a traced phase (no reference to its pixels is kept)
+ */
+struct TraceShape {
+    cv::Size size;
+    int channels = 0;
+
+    TraceShape() = default;
+    TraceShape(const cv::Mat& image)
+        : size(image.size()), channels(image.empty() ? 0 : image.channels()) {}
+};
+
+/**
+ * one timed phase of an operation call (or a whole pipeline step)
+ */
+struct TraceEvent {
+    std::string operation;
+    std::string phase;            // step, preExecute, validateParameters, executeImpl, executeInPlaceImpl, postExecute
+    int step = -1;                // pipeline step, -1 outside an executor
+    int tile = -1;                // tile of a tiled chain, -1 when untiled
+    int thread = 0;               // small per-recorder thread number
+    double start_us = 0.0;        // since the recorder was created
+    double wall_us = 0.0;
+    double cpu_us = 0.0;          // cpu time of the calling thread (not of opencv's worker threads)
+    size_t bytes_allocated = 0;   // cv::Mat allocations made by the calling thread
+    TraceShape input;
+    TraceShape output;
+};
+
+// collects per-operation trace events from any number of threads; tracing is
+// off (a single thread-local check per phase) unless a recorder is made current
+// on the thread with a Scope
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // counters read at the start of a phase
+    struct Mark {
+        Clock::time_point wall;
+        double cpu_us = 0.0;
+        size_t allocated = 0;
+    };
+
+    TraceRecorder();
+
+    // read the counters of the calling thread
+    static Mark mark();
+
+    // add the phase that started at `begin` and ends now; thread-safe
+    void record(const std::string& operation, const std::string& phase, const Mark& begin,
+                const TraceShape& input, const TraceShape& output);
+
+    // snapshot of everything recorded so far, in recording order
+    std::vector<TraceEvent> events() const;
+
+    // one json object per line
+    void writeJsonLines(std::ostream& out) const;
+
+    // chrome trace-event format, for chrome://tracing or ui.perfetto.dev
+    void writeChromeTrace(std::ostream& out) const;
+
+    // write to a file: .jsonl gives json lines, anything else a chrome trace
+    bool save(const std::string& path) const;
+
+    // makes a recorder current on this thread, tagging events with a step and tile;
+    // a null recorder keeps whichever one is already current
+    class Scope {
+    public:
+        explicit Scope(TraceRecorder* recorder, int step = -1, int tile = -1);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TraceRecorder* previous;
+        int previous_step;
+        int previous_tile;
+    };
+
+    // recorder made current on this thread by a Scope, or nullptr
+    static TraceRecorder* current();
+
+private:
+    Clock::time_point origin;
+
+    mutable std::mutex mutex;
+    std::vector<TraceEvent> recorded;
+    std::map<std::thread::id, int> thread_numbers;
+
+    // route cv::Mat allocations through a counting allocator (once per process)
+    static void installAllocationCounter();
+};
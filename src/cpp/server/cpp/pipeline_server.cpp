@@ -0,0 +1,357 @@
+#include "../hpp/pipeline_server.hpp"
+#include "../../pipeline/hpp/image_loader.hpp"
+#include "../../runtime/hpp/content_hash.hpp"
+#include "../../runtime/hpp/scheduler.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+    // frames larger than this are treated as corrupt input
+    const size_t max_header_bytes = size_t(16) << 20;
+    const size_t max_payload_bytes = size_t(1) << 30;
+}
+
+PipelineServer::PipelineServer(const ServerOptions& options)
+    : options(options), plans(options.max_cached_plans, options.optimize, options.blur_tolerance) {
+    executor.setTileSize(options.tile_size);
+    if (options.step_cache_bytes > 0) {
+        steps = std::make_unique<StepCache>(options.step_cache_bytes);
+    }
+}
+
+int PipelineServer::run() {
+    // requests are answered one at a time, so each gets the whole thread budget
+    Scheduler::shared().plan(1);
+
+    if (options.endpoint == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        // stdout carries frames, so everything else goes to stderr
+        std::cerr << "sea vision server reading requests from stdin" << std::endl;
+        serveConnection(0, 1);
+        return 0;
+    }
+    return serveSocket();
+}
+
+json PipelineServer::handle(const json& request, const std::vector<uchar>& payload, std::vector<uchar>& response_payload) {
+    json response;
+    if (request.contains("id")) {
+        response["id"] = request["id"];
+    }
+    response_payload.clear();
+
+    try {
+        std::string command = request.value("command", "run");
+        if (command == "run") {
+            response.update(runRequest(request, payload, response_payload));
+        } else if (command == "stats") {
+            response["requests"] = requests_served;
+            response["cached_plans"] = plans.size();
+            response["plan_hits"] = plans.hits();
+            response["plan_misses"] = plans.misses();
+            response["threads"] = Scheduler::shared().current().intra_threads;
+            response["buffer_allocations"] = executor.bufferPool().allocationCount();
+            response["buffer_reuses"] = executor.bufferPool().reuseCount();
+            response["buffer_cached_bytes"] = executor.bufferPool().cachedBytes();
+            if (steps) {
+                response["step_cache_images"] = steps->size();
+                response["step_cache_bytes"] = steps->bytes();
+                response["step_cache_hits"] = steps->hits();
+                response["step_cache_misses"] = steps->misses();
+            }
+        } else if (command == "shutdown") {
+            stopping = true;
+        } else {
+            throw std::runtime_error("unknown command: " + command);
+        }
+        response["ok"] = true;
+    } catch (const std::exception& e) {
+        response["ok"] = false;
+        response["error"] = e.what();
+        response_payload.clear();
+    }
+
+    ++requests_served;
+    return response;
+}
+
+json PipelineServer::runRequest(const json& request, const std::vector<uchar>& payload, std::vector<uchar>& response_payload) {
+    auto start = std::chrono::steady_clock::now();
+
+    // region previews compute a different subset of pixels each time, so they skip the step cache
+    bool memoize = steps && !request.contains("region");
+    uint64_t input_key = memoize ? inputKey(request, payload) : 0;
+    cv::Mat image;
+    bool input_cached = memoize && steps->find(input_key, image);
+
+    if (!input_cached) {
+        // decode into a recycled buffer (reused while the input size repeats)
+        image = last_input_size.empty() ? cv::Mat() : executor.bufferPool().acquire(last_input_size, CV_8UC3);
+        if (!payload.empty()) {
+            cv::imdecode(payload, cv::IMREAD_COLOR, &image);
+        } else if (request.contains("input_image")) {
+            ImageLoader::read(request["input_image"].get<std::string>(), image);
+        } else {
+            throw std::runtime_error("request needs 'input_image' or an encoded image payload");
+        }
+        if (image.empty()) {
+            throw std::runtime_error("could not decode input image");
+        }
+        if (memoize) {
+            // only read from here on, the cache shares the decoded buffer
+            steps->adopt(input_key, image);
+        }
+    }
+    last_input_size = image.size();
+
+    bool cached = false;
+    std::shared_ptr<const CompiledPipeline> pipeline = planFor(request, image.size(), image.depth(), cached);
+    cv::Mat result;
+    size_t reused = 0;
+    if (request.contains("region")) {
+        // previews ask for a window of the output, only the pixels it depends on are computed
+        const json& region = request["region"];
+        result = executor.runRegion(*pipeline, image, cv::Rect(region.value("x", 0), region.value("y", 0),
+                                                               region.value("width", 0), region.value("height", 0)));
+        executor.recycle(image);
+    } else if (memoize) {
+        // the cached input is shared, the executor works in a copy
+        result = executor.runMemoized(*pipeline, image, input_key, *steps, &reused);
+        executor.recycle(image);
+    } else {
+        result = executor.runInPlace(*pipeline, image);
+    }
+
+    json response;
+    response["width"] = result.cols;
+    response["height"] = result.rows;
+    response["channels"] = result.channels();
+    response["plan_cached"] = cached;
+    if (memoize) {
+        response["input_cached"] = input_cached;
+        response["steps"] = pipeline->steps.size();
+        response["steps_reused"] = reused;
+    }
+
+    bool stored = true;
+    if (request.contains("output_image")) {
+        stored = ImageLoader::save(request["output_image"].get<std::string>(), result);
+    } else {
+        std::string format = request.value("format", ".png");
+        stored = !format.empty() && format[0] == '.' && cv::imencode(format, result, response_payload);
+    }
+    executor.recycle(result);
+    if (!stored) {
+        throw std::runtime_error("could not encode or save the result");
+    }
+
+    response["elapsed_ms"] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return response;
+}
+
+uint64_t PipelineServer::inputKey(const json& request, const std::vector<uchar>& payload) {
+    if (!payload.empty()) {
+        return ContentHash::fnv1a(payload.data(), payload.size());
+    }
+
+    // a file is trusted to be unchanged while its size and modification time are
+    std::string identity = request.value("input_image", "");
+    std::error_code error;
+    auto size = std::filesystem::file_size(identity, error);
+    auto time = std::filesystem::last_write_time(identity, error);
+    identity += "|" + std::to_string(size) + "|" + std::to_string(time.time_since_epoch().count());
+    return ContentHash::fnv1a(identity);
+}
+
+std::shared_ptr<const CompiledPipeline> PipelineServer::planFor(const json& request, cv::Size size, int depth, bool& cached) {
+    // inline pipelines are keyed by their canonical text (dump sorts object keys), files by their contents
+    if (request.contains("pipeline")) {
+        return plans.get(request["pipeline"].dump(), size, depth, &cached);
+    }
+    if (request.contains("pipeline_file")) {
+        return plans.getFile(request["pipeline_file"].get<std::string>(), size, depth, &cached);
+    }
+    throw std::runtime_error("request needs 'pipeline' or 'pipeline_file'");
+}
+
+void PipelineServer::serveConnection(int in_fd, int out_fd) {
+    while (!stopping) {
+        json request;
+        std::vector<uchar> payload;
+        if (!readFrame(in_fd, request, payload)) {
+            return;
+        }
+
+        std::vector<uchar> response_payload;
+        json response = handle(request, payload, response_payload);
+        response["data_size"] = response_payload.size();
+        if (!writeFrame(out_fd, response, response_payload)) {
+            return;
+        }
+    }
+}
+
+int PipelineServer::serveSocket() {
+#ifdef _WIN32
+    std::cerr << "error: unix sockets are not supported on this platform, use --serve -" << std::endl;
+    return -1;
+#else
+    // a client disconnecting mid-response must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const std::string& path = options.endpoint;
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "error: socket path too long: " << path << std::endl;
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    // replace a stale socket from an earlier run, never a regular file
+    struct stat existing;
+    if (::stat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "error: '" << path << "' exists and is not a socket" << std::endl;
+            return -1;
+        }
+        ::unlink(path.c_str());
+    }
+
+    int server_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0 || ::bind(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(server_fd, 8) != 0) {
+        std::cerr << "error: could not listen on '" << path << "': " << std::strerror(errno) << std::endl;
+        if (server_fd >= 0) {
+            ::close(server_fd);
+        }
+        return -1;
+    }
+
+    std::cerr << "sea vision server listening on " << path << std::endl;
+    while (!stopping) {
+        int client_fd = ::accept(server_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "error: accept failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        serveConnection(client_fd, client_fd);
+        ::close(client_fd);
+    }
+
+    ::close(server_fd);
+    ::unlink(path.c_str());
+    return 0;
+#endif
+}
+
+bool PipelineServer::readFrame(int fd, json& header, std::vector<uchar>& payload) {
+    unsigned char length_bytes[4];
+    if (!readExact(fd, length_bytes, sizeof(length_bytes))) {
+        return false;
+    }
+    size_t length = (size_t(length_bytes[0]) << 24) | (size_t(length_bytes[1]) << 16)
+                  | (size_t(length_bytes[2]) << 8) | size_t(length_bytes[3]);
+    if (length == 0 || length > max_header_bytes) {
+        std::cerr << "error: malformed request frame" << std::endl;
+        return false;
+    }
+
+    std::string text(length, '\0');
+    if (!readExact(fd, &text[0], length)) {
+        return false;
+    }
+    header = json::parse(text, nullptr, false);
+    if (header.is_discarded() || !header.is_object()) {
+        std::cerr << "error: request header is not a json object" << std::endl;
+        return false;
+    }
+
+    json data_size = header.value("data_size", json(0));
+    if (!data_size.is_number_integer() || data_size.get<long long>() < 0) {
+        std::cerr << "error: invalid data_size in request" << std::endl;
+        return false;
+    }
+    size_t size = data_size.get<size_t>();
+    if (size > max_payload_bytes) {
+        std::cerr << "error: request payload too large" << std::endl;
+        return false;
+    }
+
+    payload.resize(size);
+    return size == 0 || readExact(fd, payload.data(), size);
+}
+
+bool PipelineServer::writeFrame(int fd, const json& header, const std::vector<uchar>& payload) {
+    std::string text = header.dump();
+    unsigned char length_bytes[4] = {
+        static_cast<unsigned char>(text.size() >> 24), static_cast<unsigned char>(text.size() >> 16),
+        static_cast<unsigned char>(text.size() >> 8), static_cast<unsigned char>(text.size())
+    };
+
+    return writeExact(fd, length_bytes, sizeof(length_bytes)) && writeExact(fd, text.data(), text.size())
+        && (payload.empty() || writeExact(fd, payload.data(), payload.size()));
+}
+
+bool PipelineServer::readExact(int fd, void* data, size_t size) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        int count = _read(fd, out, static_cast<unsigned int>(size));
+#else
+        ssize_t count = ::read(fd, out, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (count <= 0) {
+            return false;
+        }
+        out += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+bool PipelineServer::writeExact(int fd, const void* data, size_t size) {
+    const char* in = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        int count = _write(fd, in, static_cast<unsigned int>(size));
+#else
+        ssize_t count = ::write(fd, in, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (count <= 0) {
+            return false;
+        }
+        in += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
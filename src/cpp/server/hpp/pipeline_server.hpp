@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../../bindings/hpp/pipeline_reader.hpp"
+#include "../../pipeline/hpp/pipeline_compiler.hpp"
+#include "../../pipeline/hpp/pipeline_executor.hpp"
+#include "../../pipeline/hpp/plan_cache.hpp"
+#include "../../pipeline/hpp/step_cache.hpp"
+#include "../../../../include/json-develop/single_include/nlohmann/json.hpp"
+
+/**
+ * settings for a server run
+ */
+struct ServerOptions {
+    std::string endpoint;             // unix socket path, or "-" for stdin/stdout
+    bool optimize = true;
+    double blur_tolerance = 0.0;      // see OptimizeOptions
+    int tile_size = 0;
+    size_t max_cached_plans = 64;
+    size_t step_cache_bytes = 0;      // decoded inputs and per-step intermediates kept for reruns, 0 disables
+};
+
+// pipeline server class - long-running process that keeps compiled plans (by content hash)
+// and its buffer pool warm across requests.
+//
+// every message, in both directions, is one frame:
+//   4-byte big-endian header length | json header | data_size bytes of payload
+// requests:  {"id", "command": "run" (default) | "stats" | "shutdown",
+//             "pipeline": {...} or "pipeline_file": path,
+//             "input_image": path, or the encoded image as payload with "data_size",
+//             "output_image": path, or "format" (default ".png") to get the encoded result back}
+// responses: {"id", "ok", "error", "width", "height", "channels", "data_size", "elapsed_ms", "plan_cached",
+//             "input_cached", "steps", "steps_reused"}
+//
+// with a step cache, the decoded input and the image after every step stay in memory, keyed by
+// the input (payload bytes, or path, size and modification time) and the steps so far; a
+// rerun that changes step k of a pipeline skips the decode and steps before k
+class PipelineServer {
+public:
+    explicit PipelineServer(const ServerOptions& options);
+
+    // serve until a shutdown request (stdin/stdout mode also stops at end of input)
+    int run();
+
+    // answer one request; the response payload is filled for encoded results
+    nlohmann::json handle(const nlohmann::json& request, const std::vector<uchar>& payload,
+                          std::vector<uchar>& response_payload);
+
+private:
+    ServerOptions options;
+    PipelineExecutor executor;
+    PlanCache plans;
+    std::unique_ptr<StepCache> steps;
+    bool stopping = false;
+    size_t requests_served = 0;
+    cv::Size last_input_size;
+
+    // compiled plan for the request's pipeline at this input size and depth; sets `cached` on a hit
+    std::shared_ptr<const CompiledPipeline> planFor(const nlohmann::json& request, cv::Size size, int depth, bool& cached);
+
+    // key of the request's input for the step cache, without decoding it
+    static uint64_t inputKey(const nlohmann::json& request, const std::vector<uchar>& payload);
+
+    // run a "run" request
+    nlohmann::json runRequest(const nlohmann::json& request, const std::vector<uchar>& payload,
+                              std::vector<uchar>& response_payload);
+
+    // answer frames until the peer closes, a frame is malformed or a shutdown arrives
+    void serveConnection(int in_fd, int out_fd);
+
+    // listen on a unix domain socket, one connection at a time
+    int serveSocket();
+
+    // read one frame, false at end of input or on a malformed frame
+    static bool readFrame(int fd, nlohmann::json& header, std::vector<uchar>& payload);
+
+    // write one frame, false if the peer went away
+    static bool writeFrame(int fd, const nlohmann::json& header, const std::vector<uchar>& payload);
+
+    static bool readExact(int fd, void* data, size_t size);
+    static bool writeExact(int fd, const void* data, size_t size);
+};
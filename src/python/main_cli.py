@@ -4,6 +4,7 @@ import os
 from pathlib import Path
 import json
 import subprocess
+from sea_vision_client import SeaVisionClient
 
 # define available operations and their parameters
 OPERATIONS = [
@@ -42,6 +43,14 @@ OPERATIONS = [
             {"name": "strength", "type": float, "prompt": "strength (0.0-2.0, default 1.0)", "default": 1.0},
             {"name": "kernel_size", "type": int, "prompt": "kernel size (odd, 3-15, default 5)", "default": 5}
         ]
+    },
+    {
+        "name": "resize",
+        "params": [
+            {"name": "scale", "type": float, "prompt": "scale (0.0-8.0, default 1.0)", "default": 1.0},
+            {"name": "width", "type": int, "prompt": "width (default: from scale or height)", "default": None},
+            {"name": "height", "type": int, "prompt": "height (default: from scale or width)", "default": None}
+        ]
     }
 ]
 
@@ -94,7 +103,123 @@ def prompt_for_roi():
         "height": height
     }
 
+def run_on_server(socket_path, pipeline, input_image, output_image):
+    # a running `sea_vision --serve` keeps compiled pipelines warm, no process launch per job
+    print(f"sending pipeline to server at {socket_path}")
+    try:
+        with SeaVisionClient.connect(socket_path) as client:
+            response, _ = client.run(pipeline, input_image=input_image, output_image=output_image)
+    except OSError as e:
+        print(f"error connecting to server: {e}")
+        return
+    if response.get("ok"):
+        print(f"pipeline executed successfully in {response['elapsed_ms']:.1f} ms.")
+    else:
+        print(f"error running pipeline: {response.get('error')}")
+
+def find_operation(name):
+    for op in OPERATIONS:
+        if op["name"] == name:
+            return op
+    return None
+
+def print_pipeline(operations):
+    for idx, operation in enumerate(operations, 1):
+        params = ", ".join(f"{name}={value}" for name, value in operation["parameters"].items())
+        print(f"  {idx}. {operation['type']}({params})")
+
+def session_step(text, operations):
+    # 1-based step number from a command argument, None if out of range
+    try:
+        index = int(text)
+    except ValueError:
+        return None
+    return index - 1 if 1 <= index <= len(operations) else None
+
+def run_session(socket_path, pipeline, json_path):
+    # the server keeps the decoded input and the output of every step but the last, so a rerun
+    # after editing step k only computes steps k.. onwards
+    exe_path = os.path.join("build", "Release", "sea_vision.exe")
+    try:
+        if socket_path:
+            client = SeaVisionClient.connect(socket_path)
+        else:
+            client = SeaVisionClient.spawn(exe_path, ["--step-cache", "512"])
+    except OSError as e:
+        print(f"error starting session: {e}")
+        return
+
+    operations = pipeline["operations"]
+    print("\nsession commands: run, list, edit <n>, add, delete <n>, quit")
+    with client:
+        command = "run"
+        while True:
+            words = command.split()
+            action = words[0] if words else ""
+            step = session_step(words[1], operations) if len(words) > 1 else None
+            if action == "run":
+                with open(json_path, "w") as f:
+                    json.dump(pipeline, f, indent=2)
+                try:
+                    response, _ = client.run(pipeline, input_image=pipeline["input_image"],
+                                             output_image=pipeline["output_image"])
+                except OSError as e:
+                    print(f"error talking to server: {e}")
+                    return
+                if not response.get("ok"):
+                    print(f"error running pipeline: {response.get('error')}")
+                elif "steps_reused" in response:
+                    print(f"ran in {response['elapsed_ms']:.1f} ms, "
+                          f"{response['steps_reused']} of {response['steps']} steps reused")
+                else:
+                    print(f"ran in {response['elapsed_ms']:.1f} ms (server has no step cache)")
+            elif action == "list":
+                print_pipeline(operations)
+            elif action == "edit" and step is not None:
+                operations[step]["parameters"] = prompt_for_params(find_operation(operations[step]["type"]))
+            elif action == "add":
+                op_num = prompt_for_operation()
+                if op_num != 0:
+                    op = OPERATIONS[op_num - 1]
+                    operations.append({"type": op["name"], "parameters": prompt_for_params(op)})
+            elif action == "delete" and step is not None:
+                del operations[step]
+            elif action == "quit":
+                return
+            else:
+                print("usage: run | list | edit <n> | add | delete <n> | quit")
+            command = input("session> ").strip()
+
+def load_extension():
+    # the in-process module, built next to the executable when python headers are available
+    for build_dir in (os.path.join("build", "Release"), "build"):
+        if build_dir not in sys.path:
+            sys.path.append(build_dir)
+    try:
+        import sea_vision
+    except ImportError:
+        return None
+    return sea_vision
+
+def run_in_process(sea_vision, pipeline, input_image, output_image):
+    # no process launch and no json file round trip; pixels stay in memory between steps
+    print("running pipeline in-process")
+    try:
+        result = sea_vision.Pipeline(pipeline).run(sea_vision.imread(input_image), in_place=True)
+        sea_vision.imwrite(output_image, result)
+    except (OSError, RuntimeError, ValueError) as e:
+        print(f"error running pipeline: {e}")
+        return
+    print(f"pipeline executed successfully, {result.width}x{result.height} result saved to {output_image}")
+
 def main():
+    parser = argparse.ArgumentParser(description="sea vision pipeline builder")
+    parser.add_argument("--server", help="unix socket of a running `sea_vision --serve` to send the pipeline to")
+    parser.add_argument("--subprocess", action="store_true", help="run the executable even when the python module is available")
+    parser.add_argument("--session", action="store_true",
+                        help="keep editing and rerunning the pipeline; unchanged leading steps are reused")
+    args = parser.parse_args()
+
     print("welcome to the sea vision pipeline builder!")
     operations = []
     while True:
@@ -126,6 +251,16 @@ def main():
     with open(json_path, "w") as f:
         json.dump(pipeline, f, indent=2)
     print(f"pipeline json written to {json_path}")
+    if args.session:
+        run_session(args.server, pipeline, json_path)
+        return
+    if args.server:
+        run_on_server(args.server, pipeline, input_image, output_image)
+        return
+    sea_vision = None if args.subprocess else load_extension()
+    if sea_vision is not None:
+        run_in_process(sea_vision, pipeline, input_image, output_image)
+        return
     # run the c++ executable
     exe_path = os.path.join("build", "Release", "sea_vision.exe")
     cmd = [exe_path, json_path, input_image, output_image]
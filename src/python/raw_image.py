@@ -0,0 +1,44 @@
+import mmap
+import struct
+
+# reader for sea_vision's raw (.svraw) images: a little-endian header, then the pixel rows
+# at data_offset in opencv's interleaved layout. the pixels are mapped, not read
+
+HEADER = struct.Struct("<8s6I2Q")
+MAGIC = b"SVRAWIMG"
+
+# opencv depth codes and the struct format of one channel value
+DEPTHS = {0: "B", 1: "b", 2: "H", 3: "h", 4: "i", 5: "f", 6: "d", 7: "e"}
+
+
+class RawImage:
+    def __init__(self, path):
+        with open(path, "rb") as file:
+            self._map = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, data_offset, width, height, cv_type, _, row_stride, data_size = HEADER.unpack_from(self._map)
+        if magic != MAGIC or version != 1 or data_offset + data_size > len(self._map):
+            self._map.close()
+            raise ValueError(f"'{path}' is not a valid raw image")
+
+        self.width = width
+        self.height = height
+        self.channels = (cv_type >> 3) + 1
+        self.format = DEPTHS[cv_type & 7]
+        self.row_stride = row_stride
+        self._offset = data_offset
+        self._size = data_size
+
+    @property
+    def pixels(self):
+        """read-only memoryview of the pixel rows (row_stride bytes each), without a copy;
+        e.g. numpy.frombuffer(image.pixels, numpy.uint8).reshape(height, width, channels)"""
+        return memoryview(self._map)[self._offset:self._offset + self._size]
+
+    def close(self):
+        self._map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
@@ -0,0 +1,102 @@
+import json
+import socket
+import struct
+import subprocess
+
+# client for `sea_vision --serve`: every message is a 4-byte big-endian header
+# length, a json header, then header["data_size"] bytes of payload
+
+
+class SeaVisionClient:
+    def __init__(self, reader, writer, closer=None):
+        self._reader = reader
+        self._writer = writer
+        self._closer = closer
+        self._next_id = 1
+
+    @classmethod
+    def connect(cls, socket_path):
+        """connect to a server listening on a unix domain socket"""
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(socket_path)
+        stream = sock.makefile("rwb")
+
+        def close():
+            stream.close()
+            sock.close()
+
+        return cls(stream, stream, close)
+
+    @classmethod
+    def spawn(cls, exe_path, args=()):
+        """start a private server talking over stdin/stdout; args are extra options
+        (e.g. ["--step-cache", "512"])"""
+        process = subprocess.Popen([exe_path, *args, "--serve", "-"], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+        def close():
+            process.stdin.close()
+            process.wait()
+
+        return cls(process.stdout, process.stdin, close)
+
+    def run(self, pipeline, input_image=None, data=None, output_image=None, fmt=".png", region=None):
+        """run a pipeline (dict, or path of a json file) on an image path or encoded bytes;
+        region (x, y, width, height) computes only that window of the output.
+        returns (response header, encoded result bytes or None when output_image is set)"""
+        request = {"command": "run"}
+        if isinstance(pipeline, dict):
+            request["pipeline"] = pipeline
+        else:
+            request["pipeline_file"] = str(pipeline)
+        if input_image is not None:
+            request["input_image"] = str(input_image)
+        if region is not None:
+            x, y, width, height = region
+            request["region"] = {"x": x, "y": y, "width": width, "height": height}
+        if output_image is not None:
+            request["output_image"] = str(output_image)
+        else:
+            request["format"] = fmt
+        return self.request(request, data)
+
+    def stats(self):
+        return self.request({"command": "stats"})[0]
+
+    def shutdown(self):
+        return self.request({"command": "shutdown"})[0]
+
+    def request(self, header, payload=None):
+        header = dict(header)
+        header["id"] = self._next_id
+        self._next_id += 1
+        header["data_size"] = len(payload) if payload else 0
+
+        text = json.dumps(header).encode("utf-8")
+        self._writer.write(struct.pack(">I", len(text)) + text + (payload or b""))
+        self._writer.flush()
+
+        length = struct.unpack(">I", self._read_exact(4))[0]
+        response = json.loads(self._read_exact(length).decode("utf-8"))
+        data = self._read_exact(response.get("data_size", 0)) if response.get("data_size") else None
+        return response, data
+
+    def close(self):
+        if self._closer:
+            self._closer()
+            self._closer = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def _read_exact(self, size):
+        chunks = []
+        while size > 0:
+            chunk = self._reader.read(size)
+            if not chunk:
+                raise ConnectionError("sea vision server closed the connection")
+            chunks.append(chunk)
+            size -= len(chunk)
+        return b"".join(chunks)
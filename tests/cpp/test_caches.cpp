@@ -0,0 +1,138 @@
+#include "test_runner.hpp"
+#include "../../src/cpp/pipeline/hpp/pipeline_executor.hpp"
+#include "../../src/cpp/pipeline/hpp/result_cache.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // four steps (the tables are not neighbours, so nothing fuses); `tail` sets the last one
+    PipelineConfig tuningPipeline(double second, double tail) {
+        return TestRunner::parse(R"({
+            "operations": [
+                {"type": "blur", "parameters": {"kernel_size": 5, "sigma": 1.2}},
+                {"type": "contrast", "parameters": {"factor": )" + std::to_string(second) + R"(, "brightness_offset": 4}},
+                {"type": "sharpen", "parameters": {"strength": 0.9, "kernel_size": 3}},
+                {"type": "brightness", "parameters": {"factor": )" + std::to_string(tail) + R"(}}
+            ]
+        })");
+    }
+
+    std::string brightnessPipeline(double factor) {
+        return ResultCache::describe(TestRunner::parse(R"({"operations": [{"type": "brightness", "parameters": {"factor": )"
+                                                       + std::to_string(factor) + "}}]}"),
+                                     false, 0.0, {});
+    }
+}
+
+TEST_CASE(result_cache_hits_and_evicts) {
+    std::string directory = TestRunner::scratchDirectory("result_cache");
+    fs::path files = fs::path(directory) / "files";
+    fs::path cache_directory = fs::path(directory) / "cache";
+    fs::create_directories(files);
+
+    cv::Mat image = TestRunner::sampleImage(cv::Size(160, 120));
+    std::string input = (files / "input.png").string();
+    std::string copy = (files / "copy.png").string();
+    std::string output = (files / "output.png").string();
+    std::string fetched = (files / "fetched.png").string();
+    CHECK(cv::imwrite(input, image));
+    fs::copy_file(input, copy);
+    CHECK(cv::imwrite(output, cv::Mat(255 - image)));
+
+    // keys cover the input's bytes, the output format and the pipeline
+    ResultCache cache(cache_directory.string(), uint64_t(1) << 30, false);
+    std::string key = cache.key(input, output, brightnessPipeline(1.2));
+    CHECK(key.size() == 64);
+    CHECK(cache.key(copy, output, brightnessPipeline(1.2)) == key);
+    CHECK(cache.key(input, (files / "output.jpg").string(), brightnessPipeline(1.2)) != key);
+    CHECK(cache.key(input, output, brightnessPipeline(1.3)) != key);
+    CHECK(cache.key((files / "missing.png").string(), output, brightnessPipeline(1.2)).empty());
+
+    // a miss, then a hit in a later run with the stored bytes
+    CHECK(!cache.fetch(key, fetched));
+    cache.store(key, output);
+    ResultCache later(cache_directory.string(), uint64_t(1) << 30, false);
+    CHECK(later.fetch(key, fetched));
+    CHECK(readFile(fetched) == readFile(output));
+    CHECK(later.hits() == 1 && later.misses() == 0);
+
+    // an entry stored by another process after this one looked at the directory
+    std::string other_key = cache.key(input, output, brightnessPipeline(0.5));
+    CHECK(!later.fetch(other_key, fetched));
+    cache.store(other_key, output);
+    CHECK(later.fetch(other_key, fetched));
+
+    // a bound of two and a half entries keeps the two most recently used; files that are not
+    // entries are never counted or removed
+    uint64_t entry_bytes = fs::file_size(output);
+    fs::path notes = cache_directory / "notes.txt";
+    std::ofstream(notes) << std::string(4 * entry_bytes, 'x');
+    ResultCache bounded(cache_directory.string(), entry_bytes * 5 / 2, false);
+    std::string third_key = cache.key(input, output, brightnessPipeline(0.7));
+    CHECK(bounded.fetch(key, fetched));
+    bounded.store(third_key, output);
+    CHECK(bounded.bytes() <= entry_bytes * 5 / 2);
+    CHECK(!bounded.fetch(other_key, fetched));
+    CHECK(bounded.fetch(key, fetched));
+    CHECK(bounded.fetch(third_key, fetched));
+    CHECK(fs::exists(notes));
+
+    // temporaries of a crashed run are removed once stale, a live writer's are kept
+    fs::path stale = cache_directory / ("." + key + ".png-0-1");
+    fs::path live = cache_directory / ("." + key + ".png-0-2");
+    std::ofstream(stale) << "x";
+    std::ofstream(live) << "x";
+    fs::last_write_time(stale, fs::file_time_type::clock::now() - std::chrono::hours(2));
+    ResultCache restarted(cache_directory.string(), uint64_t(1) << 30, false);
+    CHECK(!fs::exists(stale));
+    CHECK(fs::exists(live));
+}
+
+TEST_CASE(step_cache_reuses_prefixes) {
+    cv::Mat image = TestRunner::sampleImage(cv::Size(160, 120));
+    const uint64_t input_key = 42;
+    size_t image_bytes = image.total() * image.elemSize();
+    PipelineExecutor executor;
+
+    // each run matches a plain one and resumes after the last unchanged step; the last
+    // step's output is never kept
+    StepCache cache(size_t(1) << 30);
+    struct Run {
+        double second;
+        double tail;
+        size_t reused;
+    };
+    for (const Run& run : {Run{1.2, 1.1, 0}, Run{1.2, 0.9, 3}, Run{1.2, 0.9, 3}, Run{1.5, 0.9, 1}, Run{1.2, 1.1, 3}}) {
+        PipelineConfig config = tuningPipeline(run.second, run.tail);
+        CompiledPipeline pipeline = PipelineCompiler::compile(config);
+        CHECK(pipeline.steps.size() == 4);
+        size_t reused = 99;
+        CHECK_SAME(executor.runMemoized(pipeline, image, input_key, cache, &reused), TestRunner::run(config, image));
+        CHECK(reused == run.reused);
+    }
+    CHECK(cache.size() == 5);
+
+    // with room for two and a half images, a chain loses its deepest images first and keeps
+    // the input and the first step
+    StepCache small(image_bytes * 5 / 2);
+    small.adopt(input_key, image);
+    CompiledPipeline pipeline = PipelineCompiler::compile(tuningPipeline(1.2, 1.1));
+    size_t reused = 99;
+    executor.runMemoized(pipeline, image, input_key, small, &reused);
+    CHECK(reused == 0);
+    CHECK(small.size() == 2);
+    cv::Mat kept;
+    CHECK(small.find(input_key, kept));
+    CompiledPipeline changed = PipelineCompiler::compile(tuningPipeline(1.2, 0.9));
+    executor.runMemoized(changed, image, input_key, small, &reused);
+    CHECK(reused == 1);
+}
@@ -0,0 +1,82 @@
+#include "test_runner.hpp"
+#include "sea_vision.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* const capi_pipeline = R"({
+        "operations": [
+            {"type": "brightness", "parameters": {"factor": 1.1}},
+            {"type": "sharpen", "parameters": {"strength": 0.7, "kernel_size": 5}},
+            {"type": "crop", "parameters": {"x": 20, "y": 10, "width": 300, "height": 200}},
+            {"type": "blur", "parameters": {"kernel_size": 5, "sigma": 1.2},
+             "roi": {"x": 30, "y": 20, "width": 100, "height": 80}},
+            {"type": "resize", "parameters": {"scale": 0.5}},
+            {"type": "contrast", "parameters": {"factor": 1.2, "brightness_offset": -8}}
+        ]
+    })";
+
+    sv_image describe(const cv::Mat& image) {
+        sv_image view;
+        view.data = image.data;
+        view.stride = image.step;
+        view.width = image.cols;
+        view.height = image.rows;
+        view.channels = image.channels();
+        view.depth = image.depth();
+        return view;
+    }
+}
+
+TEST_CASE(capi_matches_cli) {
+    std::string directory = TestRunner::scratchDirectory("capi");
+    std::string input_path = (fs::path(directory) / "input.png").string();
+    std::string pipeline_path = (fs::path(directory) / "pipeline.json").string();
+    std::string output_path = (fs::path(directory) / "output.png").string();
+
+    cv::Mat image = TestRunner::sampleImage(cv::Size(397, 263));
+    CHECK(cv::imwrite(input_path, image));
+    std::ofstream(pipeline_path) << capi_pipeline;
+
+    std::string command = std::string("\"") + SEA_VISION_CLI + "\" \"" + pipeline_path + "\" \"" + input_path + "\" \""
+                          + output_path + "\" > \"" + (fs::path(directory) / "cli.log").string() + "\" 2>&1";
+    CHECK(std::system(command.c_str()) == 0);
+    cv::Mat cli = cv::imread(output_path, cv::IMREAD_UNCHANGED);
+    CHECK(!cli.empty());
+
+    sv_plan* plan = nullptr;
+    CHECK(sv_plan_create(capi_pipeline, 0, &plan) == SV_OK);
+    sv_image input = describe(image);
+    sv_image shape;
+    CHECK(sv_plan_output_shape(plan, &input, &shape) == SV_OK);
+    CHECK(shape.width == cli.cols && shape.height == cli.rows && shape.channels == cli.channels());
+
+    // into a packed buffer, and into one with padded rows
+    cv::Mat packed(shape.height, shape.width, CV_MAKETYPE(shape.depth, shape.channels));
+    sv_image output = describe(packed);
+    CHECK(sv_plan_execute(plan, &input, &output) == SV_OK);
+    CHECK_SAME(packed, cli);
+
+    cv::Mat padded_rows(shape.height, shape.width + 7, packed.type(), cv::Scalar::all(0));
+    cv::Mat padded = padded_rows(cv::Rect(0, 0, shape.width, shape.height));
+    output = describe(padded);
+    CHECK(sv_plan_execute(plan, &input, &output) == SV_OK);
+    CHECK_SAME(padded, cli);
+    sv_plan_destroy(plan);
+
+    // in place, when the output keeps the input's shape
+    const char* pointwise = R"({"operations": [{"type": "sharpen", "parameters": {"strength": 1.0, "kernel_size": 3}}]})";
+    CHECK(sv_plan_create(pointwise, 0, &plan) == SV_OK);
+    cv::Mat in_place = image.clone();
+    sv_image buffer = describe(in_place);
+    CHECK(sv_plan_execute(plan, &buffer, &buffer) == SV_OK);
+    CHECK_SAME(in_place, TestRunner::run(TestRunner::parse(pointwise), image));
+    sv_plan_destroy(plan);
+
+    // errors come back as codes with a message, never as exceptions
+    CHECK(sv_plan_create(R"({"operations": [{"type": "nope"}]})", 0, &plan) == SV_ERROR_PIPELINE);
+    CHECK(std::string(sv_last_error()).size() > 0);
+}
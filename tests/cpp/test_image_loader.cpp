@@ -0,0 +1,100 @@
+#include "test_runner.hpp"
+#include "../../src/cpp/pipeline/hpp/image_loader.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // jpeg of `image`, with an exif block giving `orientation` unless it is 1
+    void writeJpeg(const std::string& path, const cv::Mat& image, int orientation = 1) {
+        std::vector<uchar> encoded;
+        cv::imencode(".jpg", image, encoded, {cv::IMWRITE_JPEG_QUALITY, 95});
+        if (orientation != 1) {
+            // APP1 right after SOI: "Exif", a big-endian tiff header and ifd0 with the orientation tag
+            const uchar exif[] = {
+                0xFF, 0xE1, 0x00, 0x22, 'E', 'x', 'i', 'f', 0, 0,
+                'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08,
+                0x00, 0x01,
+                0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, static_cast<uchar>(orientation), 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00,
+            };
+            encoded.insert(encoded.begin() + 2, exif, exif + sizeof(exif));
+        }
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(encoded.data()),
+                                                     static_cast<std::streamsize>(encoded.size()));
+    }
+
+    // mean absolute difference between the interiors of two images, the second moved by `shift`
+    double shiftedDifference(const cv::Mat& a, const cv::Mat& b, cv::Point shift) {
+        cv::Rect inner(2, 2, a.cols - 4, a.rows - 4);
+        cv::Mat difference;
+        cv::absdiff(a(inner), b(inner + shift), difference);
+        cv::Scalar mean = cv::mean(difference);
+        return (mean[0] + mean[1] + mean[2]) / 3.0;
+    }
+}
+
+TEST_CASE(reduced_decode_matches_full_decode) {
+    // odd sizes, so the decoder rounds the reduced dimensions up
+    std::string directory = TestRunner::scratchDirectory("reduced_decode");
+    cv::Mat source;
+    cv::GaussianBlur(TestRunner::sampleImage(cv::Size(803, 611)), source, cv::Size(0, 0), 2.0);
+
+    // a plain shrink and crops away from and touching the far edges; the last one only fits
+    // the frame as stored, not turned on its side
+    const char* const crops[] = {"", R"({"type": "crop", "parameters": {"x": 101, "y": 53, "width": 500, "height": 401}},)",
+                                 R"({"type": "crop", "parameters": {"x": 203, "y": 170, "width": 600, "height": 441}},)"};
+
+    // upright, and upside down or turned a quarter: the decoder turns the scaled image, so
+    // oriented inputs are decoded in full
+    for (int orientation : {1, 3, 6}) {
+        std::string path = (fs::path(directory) / ("input_" + std::to_string(orientation) + ".jpg")).string();
+        writeJpeg(path, source, orientation);
+        cv::Mat full = cv::imread(path, cv::IMREAD_COLOR);
+        CHECK(full.size() == (orientation == 6 ? cv::Size(611, 803) : source.size()));
+
+        cv::Size size;
+        CHECK(ImageLoader::readJpegSize(path, size));
+        CHECK(size == source.size());
+
+        for (const char* crop : crops) {
+            if (orientation == 6 && crop == crops[2]) {
+                continue;
+            }
+            for (int reduction : {2, 4, 8}) {
+                PipelineConfig config = TestRunner::parse(std::string(R"({"operations": [)") + crop
+                                                          + R"({"type": "resize", "parameters": {"scale": )"
+                                                          + std::to_string(1.0 / (reduction + 0.5)) + R"(}},
+                    {"type": "sharpen", "parameters": {"strength": 0.5, "kernel_size": 3}}
+                ]})");
+                cv::Mat reference = TestRunner::run(config, full);
+
+                // the plan follows the frame header, the largest reduction that still shrinks
+                DecodePlan plan = ImageLoader::planDecode(config, size);
+                CHECK(plan.reduction == reduction);
+
+                cv::Mat image;
+                DecodePlan used = ImageLoader::load(path, config, true, image);
+                cv::Mat output = TestRunner::run(used.config, image);
+                CHECK(output.size() == reference.size());
+                if (orientation != 1) {
+                    CHECK(used.reduction == 1);
+                    CHECK_SAME(output, reference);
+                    continue;
+                }
+
+                // the decoder produces the planned size, and the rewritten pipeline the same
+                // content in the same place: closer to the full decode's output than the same
+                // output moved by a pixel
+                CHECK(used.reduction == reduction);
+                CHECK(image.size() == plan.decoded_size);
+                double aligned = shiftedDifference(output, reference, cv::Point());
+                CHECK(aligned < 5.0);
+                for (cv::Point shift : {cv::Point(1, 0), cv::Point(-1, 0), cv::Point(0, 1), cv::Point(0, -1)}) {
+                    CHECK(aligned < shiftedDifference(output, reference, shift));
+                }
+            }
+        }
+    }
+}
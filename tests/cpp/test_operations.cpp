@@ -0,0 +1,110 @@
+#include "test_runner.hpp"
+#include "../../src/cpp/bindings/hpp/operation_factory.hpp"
+#include "../../src/cpp/operations/hpp/kernel_engine.hpp"
+#include "../../src/cpp/pipeline/hpp/pipeline_executor.hpp"
+
+namespace {
+    using Parameters = std::map<std::string, double>;
+
+    struct OperationCase {
+        const char* type;
+        Parameters parameters;
+        Parameters other;   // valid, but not the ones bound
+    };
+
+    const OperationCase operation_cases[] = {
+        {"brightness", {{"factor", 1.4}}, {{"factor", 0.6}}},
+        {"contrast", {{"factor", 0.7}, {"brightness_offset", 20}}, {{"factor", 0.7}}},
+        {"blur", {{"kernel_size", 7}, {"sigma", 1.5}}, {{"kernel_size", 5}, {"sigma", 1.5}}},
+        {"sharpen", {{"strength", 1.2}, {"kernel_size", 5}}, {{"strength", 0.4}, {"kernel_size", 5}}},
+        {"resize", {{"scale", 0.5}}, {{"width", 100}, {"height", 50}}},
+        {"crop", {{"x", 10}, {"y", 5}, {"width", 90}, {"height", 60}}, {{"x", 0}, {"y", 0}, {"width", 90}, {"height", 60}}},
+    };
+
+    const ROI full_image(0, 0, 0, 0, true);
+}
+
+TEST_CASE(prepared_operations_match_unprepared) {
+    cv::Mat image = TestRunner::sampleImage(cv::Size(211, 143));
+    for (const auto& test : operation_cases) {
+        auto unprepared = OperationFactory::createOperation(test.type);
+        auto prepared = OperationFactory::createOperation(test.type);
+        prepared->prepare(test.parameters);
+        CHECK(prepared->isPrepared());
+        CHECK_SAME(prepared->execute(image, full_image, test.parameters),
+                   unprepared->execute(image, full_image, test.parameters));
+
+#ifndef NDEBUG
+        // bound state never answers for other parameters (checked in debug builds only)
+        CHECK_THROWS(prepared->execute(image, full_image, test.other));
+        CHECK_THROWS(prepared->footprint(test.other));
+        CHECK_THROWS(prepared->lookupTable(test.other));
+#endif
+    }
+
+    // preparing validates once, up front
+    CHECK_THROWS(OperationFactory::createOperation("blur")->prepare({{"kernel_size", 41}, {"sigma", 1.0}}));
+    CHECK_THROWS(OperationFactory::createOperation("brightness")->prepare({{"factor", -1.0}}));
+}
+
+TEST_CASE(fused_matches_unfused) {
+    // pointwise runs on the whole image and on a shared roi fuse into single steps
+    PipelineConfig config = TestRunner::parse(R"({
+        "operations": [
+            {"type": "brightness", "parameters": {"factor": 1.3}},
+            {"type": "contrast", "parameters": {"factor": 1.6, "brightness_offset": -40}},
+            {"type": "brightness", "parameters": {"factor": 0.8}},
+            {"type": "blur", "parameters": {"kernel_size": 3, "sigma": 0.8}},
+            {"type": "contrast", "parameters": {"factor": 0.5, "brightness_offset": 30},
+             "roi": {"x": 20, "y": 10, "width": 100, "height": 70}},
+            {"type": "brightness", "parameters": {"factor": 2.0},
+             "roi": {"x": 20, "y": 10, "width": 100, "height": 70}}
+        ]
+    })");
+    CHECK(PipelineCompiler::compile(config, true).steps.size() < config.operations.size());
+
+    for (int type : {CV_8UC1, CV_8UC3}) {
+        cv::Mat image = TestRunner::sampleImage(cv::Size(211, 143), type);
+        cv::Mat reference = TestRunner::run(config, image, false);
+        CHECK_SAME(TestRunner::run(config, image, true), reference);
+
+        PipelineExecutor executor;
+        CHECK_SAME(executor.run(PipelineCompiler::compile(config, true), image), reference);
+    }
+}
+
+TEST_CASE(kernel_engine_matches_opencv) {
+    for (int type : {CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_32FC3}) {
+        cv::Mat image;
+        TestRunner::sampleImage(cv::Size(173, 119), CV_MAKETYPE(CV_8U, CV_MAT_CN(type))).convertTo(image, type);
+        // a view inside a larger image sees its neighbours as the border, like opencv's filters do
+        cv::Mat view = image(cv::Rect(13, 9, 101, 77));
+
+        for (int ksize : {3, 5, 9, 15, 31}) {
+            for (double sigma : {0.0, 0.5, 1.5, 4.0}) {
+                for (const cv::Mat& source : {image, view}) {
+                    cv::Mat expected;
+                    cv::GaussianBlur(source, expected, cv::Size(ksize, ksize), sigma);
+                    cv::Mat blurred;
+                    KernelEngine::gaussianBlur(source, blurred, ksize, sigma);
+                    CHECK_SAME(blurred, expected);
+
+                    for (double strength : {0.3, 1.0, 2.0}) {
+                        cv::Mat sharpened;
+                        cv::addWeighted(source, 1.0 + strength, expected, -strength, 0, sharpened);
+                        cv::Mat unsharp;
+                        KernelEngine::unsharpMask(source, unsharp, ksize, sigma, strength);
+                        CHECK_SAME(unsharp, sharpened);
+                    }
+                }
+
+                // in place, source and destination the same image
+                cv::Mat in_place = image.clone();
+                KernelEngine::gaussianBlur(in_place, in_place, ksize, sigma);
+                cv::Mat expected;
+                cv::GaussianBlur(image, expected, cv::Size(ksize, ksize), sigma);
+                CHECK_SAME(in_place, expected);
+            }
+        }
+    }
+}
@@ -0,0 +1,273 @@
+#include "test_runner.hpp"
+#include "../../src/cpp/pipeline/hpp/graph_executor.hpp"
+#include "../../src/cpp/pipeline/hpp/pipeline_executor.hpp"
+#include "../../src/cpp/pipeline/hpp/pipeline_optimizer.hpp"
+#include "../../src/cpp/pipeline/hpp/region_planner.hpp"
+#include "../../src/cpp/runtime/hpp/scheduler.hpp"
+#include <algorithm>
+#include <set>
+
+namespace {
+    // filters and tables with a crop and an roi step between them, so tiled chains break
+    const char* const mixed_pipeline = R"({
+        "operations": [
+            {"type": "brightness", "parameters": {"factor": 1.2}},
+            {"type": "blur", "parameters": {"kernel_size": 7, "sigma": 1.5}},
+            {"type": "sharpen", "parameters": {"strength": 0.8, "kernel_size": 5}},
+            {"type": "contrast", "parameters": {"factor": 1.3, "brightness_offset": -12}},
+            {"type": "crop", "parameters": {"x": 11, "y": 7, "width": 301, "height": 200}},
+            {"type": "blur", "parameters": {"kernel_size": 5, "sigma": 1.0},
+             "roi": {"x": 40, "y": 30, "width": 120, "height": 90}},
+            {"type": "sharpen", "parameters": {"strength": 1.5, "kernel_size": 3}}
+        ]
+    })";
+
+    // a graph node's operations preceded by those of every node it reads from, as one flat pipeline
+    PipelineConfig flatChain(const PipelineGraph& graph, const std::string& name) {
+        PipelineConfig flat;
+        flat.global_roi = ROI(0, 0, 0, 0, true);
+        std::string current = name;
+        while (current != PipelineReader::graph_input) {
+            auto node = std::find_if(graph.nodes.begin(), graph.nodes.end(),
+                                     [&](const PipelineNode& candidate) { return candidate.name == current; });
+            // operations without an roi of their own keep their node's
+            std::vector<OperationConfig> operations = node->pipeline.operations;
+            for (auto& op : operations) {
+                if (op.roi.full_image) {
+                    op.roi = node->pipeline.global_roi;
+                }
+            }
+            flat.operations.insert(flat.operations.begin(), operations.begin(), operations.end());
+            current = node->input;
+        }
+        return flat;
+    }
+}
+
+TEST_CASE(tiled_matches_untiled) {
+    PipelineConfig config = TestRunner::parse(mixed_pipeline);
+    CompiledPipeline pipeline = PipelineCompiler::compile(config);
+
+    // several tile workers, and one executor throughout, so later runs reuse tile buffers
+    // sized for other tiles and types
+    Scheduler::shared().setThreadBudget(4);
+    Scheduler::shared().plan(1);
+    PipelineExecutor executor;
+    for (int type : {CV_8UC1, CV_8UC3}) {
+        cv::Mat image = TestRunner::sampleImage(cv::Size(397, 263), type);
+        cv::Mat reference = TestRunner::run(config, image);
+        for (int tile : {0, 16, 64, 100, 1000, 64, 16}) {
+            executor.setTileSize(tile);
+            CHECK_SAME(executor.run(pipeline, image), reference);
+        }
+    }
+    Scheduler::shared().setThreadBudget(0);
+    Scheduler::shared().plan(1);
+}
+
+TEST_CASE(crop_pushdown_matches_plain) {
+    cv::Mat image = TestRunner::sampleImage(cv::Size(397, 263));
+    // crops away from and touching the image's edges move to the front; a full-frame one stays
+    struct Case {
+        const char* crop;
+        bool moves;
+    };
+    for (const Case& test : {Case{R"({"x": 50, "y": 40, "width": 120, "height": 80})", true},
+                             Case{R"({"x": 0, "y": 0, "width": 64, "height": 263})", true},
+                             Case{R"({"x": 333, "y": 200, "width": 64, "height": 63})", true},
+                             Case{R"({"x": 0, "y": 0, "width": 397, "height": 263})", false}}) {
+        PipelineConfig config = TestRunner::parse(std::string(R"({
+            "operations": [
+                {"type": "brightness", "parameters": {"factor": 1.2}},
+                {"type": "blur", "parameters": {"kernel_size": 7, "sigma": 1.5}},
+                {"type": "sharpen", "parameters": {"strength": 0.8, "kernel_size": 5}},
+                {"type": "contrast", "parameters": {"factor": 1.3, "brightness_offset": -12}},
+                {"type": "crop", "parameters": )") + test.crop + "}]}");
+        cv::Mat reference = TestRunner::run(config, image);
+
+        PipelineConfig pushed = PipelineOptimizer::pushDownCrops(config, image.size());
+        CHECK((pushed.operations.front().type == "crop") == test.moves);
+        CHECK_SAME(TestRunner::run(pushed, image), reference);
+        CHECK_SAME(TestRunner::run(PipelineOptimizer::optimize(config, image.size()), image), reference);
+    }
+}
+
+TEST_CASE(region_matches_cropped_output) {
+    cv::Mat image = TestRunner::sampleImage(cv::Size(397, 263));
+    // the mixed pipeline, and one whose resize runs over the whole image before the region
+    const std::string resized = R"({
+        "operations": [
+            {"type": "sharpen", "parameters": {"strength": 1.0, "kernel_size": 3}},
+            {"type": "resize", "parameters": {"scale": 0.75}},
+            {"type": "blur", "parameters": {"kernel_size": 9, "sigma": 2.0}},
+            {"type": "contrast", "parameters": {"factor": 1.4, "brightness_offset": 5}}
+        ]
+    })";
+    for (const std::string& text : {std::string(mixed_pipeline), resized}) {
+        PipelineConfig config = TestRunner::parse(text);
+        CompiledPipeline pipeline = PipelineCompiler::compile(config);
+        cv::Mat full = TestRunner::run(config, image);
+
+        // inside, at each corner, a single pixel and the whole output
+        cv::Size size = full.size();
+        for (cv::Rect region : {cv::Rect(60, 50, 80, 40), cv::Rect(0, 0, 33, 21),
+                                cv::Rect(size.width - 40, size.height - 30, 40, 30), cv::Rect(size.width / 2, 0, 1, 1),
+                                cv::Rect(cv::Point(), size)}) {
+            PipelineExecutor executor;
+            CHECK_SAME(executor.runRegion(pipeline, image, region), full(region));
+        }
+    }
+
+    // over whole-image filters, a small window computes a small share of a full run
+    CompiledPipeline filters = PipelineCompiler::compile(TestRunner::parse(R"({
+        "operations": [
+            {"type": "blur", "parameters": {"kernel_size": 9, "sigma": 2.0}},
+            {"type": "sharpen", "parameters": {"strength": 1.0, "kernel_size": 5}}
+        ]
+    })"));
+    CHECK(RegionPlanner::regionStart(filters) == 0);
+    CHECK(RegionPlanner::plan(filters, 0, image.size(), cv::Rect(60, 50, 20, 20)).fraction < 0.05);
+}
+
+TEST_CASE(simplified_matches_unoptimized) {
+    // identities, a table run that merges into one step and a table that cannot join it (no
+    // single step clamps like the pair), a full-frame crop, a same-size resize and two blurs
+    PipelineConfig config = TestRunner::parse(R"({
+        "operations": [
+            {"type": "brightness", "parameters": {"factor": 1.0}},
+            {"type": "contrast", "parameters": {"factor": 1.0, "brightness_offset": 40}},
+            {"type": "contrast", "parameters": {"factor": 1.0, "brightness_offset": 35}},
+            {"type": "contrast", "parameters": {"factor": 1.8, "brightness_offset": -60}},
+            {"type": "brightness", "parameters": {"factor": 1.5}},
+            {"type": "crop", "parameters": {"x": 0, "y": 0, "width": 397, "height": 263}},
+            {"type": "resize", "parameters": {"width": 397, "height": 263}},
+            {"type": "blur", "parameters": {"kernel_size": 9, "sigma": 1.0}},
+            {"type": "blur", "parameters": {"kernel_size": 9, "sigma": 1.0}},
+            {"type": "contrast", "parameters": {"factor": 1.0, "brightness_offset": 0},
+             "roi": {"x": 10, "y": 10, "width": 50, "height": 50}}
+        ]
+    })");
+
+    for (int type : {CV_8UC1, CV_8UC3}) {
+        cv::Mat image = TestRunner::sampleImage(cv::Size(397, 263), type);
+        cv::Mat reference = TestRunner::run(config, image);
+
+        // exact rewrites only: blurs stay apart without a tolerance
+        OptimizeOptions exact;
+        PipelineConfig simplified = PipelineOptimizer::simplify(config, image.size(), exact);
+        CHECK(simplified.operations.size() == 4);
+        CHECK_SAME(TestRunner::run(simplified, image), reference);
+        CHECK_SAME(TestRunner::run(PipelineOptimizer::optimize(config, image.size(), exact), image), reference);
+
+        // rounding alone can move a pixel by a level, so a tolerance below one never merges
+        OptimizeOptions strict;
+        strict.blur_tolerance = 0.5;
+        PipelineConfig unmerged = PipelineOptimizer::simplify(config, image.size(), strict);
+        CHECK(unmerged.operations.size() == 4);
+        CHECK_SAME(TestRunner::run(unmerged, image), reference);
+
+        // merged blurs stay within the tolerance
+        OptimizeOptions tolerant;
+        tolerant.blur_tolerance = 4.0;
+        PipelineConfig merged = PipelineOptimizer::simplify(config, image.size(), tolerant);
+        CHECK(merged.operations.size() == 3);
+        CHECK(TestRunner::maxDifference(TestRunner::run(merged, image), reference) <= tolerant.blur_tolerance);
+    }
+
+    // noise is the worst case for a changed kernel; the bound holds at every tolerance that merges
+    PipelineConfig blurs = TestRunner::parse(R"({
+        "operations": [
+            {"type": "blur", "parameters": {"kernel_size": 9, "sigma": 1.0}},
+            {"type": "blur", "parameters": {"kernel_size": 9, "sigma": 1.0}}
+        ]
+    })");
+    cv::Mat noise(512, 512, CV_8UC3);
+    cv::randu(noise, 0, 256);
+    cv::Mat blurred = TestRunner::run(blurs, noise);
+    for (double tolerance : {0.5, 1.0, 2.0, 4.0, 8.0}) {
+        OptimizeOptions options;
+        options.blur_tolerance = tolerance;
+        PipelineConfig merged = PipelineOptimizer::simplify(blurs, noise.size(), options);
+        CHECK(merged.operations.size() == (tolerance >= 4.0 ? 1u : 2u));
+        CHECK(TestRunner::maxDifference(TestRunner::run(merged, noise), blurred) <= tolerance);
+    }
+
+    // a pipeline of identities leaves any image as it is
+    PipelineConfig identity = TestRunner::parse(R"({
+        "operations": [
+            {"type": "brightness", "parameters": {"factor": 1.0}},
+            {"type": "contrast", "parameters": {"factor": 1.0, "brightness_offset": 0}}
+        ]
+    })");
+    CHECK(PipelineOptimizer::isIdentity(identity));
+    CHECK(!PipelineOptimizer::isIdentity(config));
+    cv::Mat image = TestRunner::sampleImage(cv::Size(64, 48));
+    CHECK_SAME(TestRunner::run(identity, image), image);
+}
+
+TEST_CASE(graph_matches_flat_pipelines) {
+    // branches run on several workers at once
+    PipelineGraph graph = PipelineReader::readGraph(SEA_VISION_SOURCE_DIR "/tests/json/test_graph.json");
+    cv::Mat image = TestRunner::sampleImage(cv::Size(397, 263));
+    CompiledGraph compiled = GraphExecutor::compile(graph, image.size());
+    Scheduler::shared().setThreadBudget(4);
+    CHECK(Scheduler::shared().plan(GraphExecutor::branchCount(compiled)).frame_workers == 2);
+
+    TraceRecorder trace;
+    GraphExecutor executor(0, &trace);
+    cv::Mat input = image.clone();
+    std::map<std::string, cv::Mat> outputs = executor.run(compiled, input);
+
+    // every output is its chain run as one pipeline
+    CHECK(outputs.size() == 2);
+    for (const auto& output : outputs) {
+        CHECK_SAME(output.second, TestRunner::run(flatChain(graph, output.first), image));
+    }
+
+    // every node ran exactly once, the shared prefix included
+    std::multiset<std::string> expected, traced;
+    for (const auto& node : compiled.nodes) {
+        for (const auto& step : node.pipeline.steps) {
+            expected.insert(step.type);
+        }
+    }
+    for (const auto& event : trace.events()) {
+        if (event.phase == "step") {
+            traced.insert(event.operation);
+        }
+    }
+    CHECK(!expected.empty());
+    CHECK(traced == expected);
+
+    // the prefix is the decoded image's only reader, so it took the buffer over
+    CHECK(input.empty());
+
+    // a chain of single readers hands one buffer down to the output; with a second reader
+    // of the decoded image, both readers work on copies of it
+    for (bool branched : {false, true}) {
+        PipelineGraph chain = PipelineReader::parseGraph(nlohmann::json::parse(std::string(R"({
+            "nodes": [
+                {"name": "a", "operations": [{"type": "brightness", "parameters": {"factor": 1.2}}]},
+                {"name": "b", "input": "a", "operations": [{"type": "contrast", "parameters": {"factor": 1.1, "brightness_offset": 5}}]},
+                {"name": "c", "input": "b", "operations": [{"type": "brightness", "parameters": {"factor": 0.9}}],
+                 "output_image": "c.png"})") + (branched ? R"(,
+                {"name": "d", "operations": [{"type": "blur", "parameters": {"kernel_size": 5, "sigma": 1.0}}],
+                 "output_image": "d.png"})" : "") + "]}"));
+        CompiledGraph chain_compiled = GraphExecutor::compile(chain, image.size());
+        Scheduler::shared().plan(GraphExecutor::branchCount(chain_compiled));
+
+        cv::Mat chain_input = image.clone();
+        const uchar* buffer = chain_input.data;
+        std::map<std::string, cv::Mat> chain_outputs = GraphExecutor().run(chain_compiled, chain_input);
+        CHECK_SAME(chain_outputs["c"], TestRunner::run(flatChain(chain, "c"), image));
+        CHECK(chain_input.empty());
+        CHECK((chain_outputs["c"].data == buffer) == !branched);
+        if (branched) {
+            CHECK_SAME(chain_outputs["d"], TestRunner::run(flatChain(chain, "d"), image));
+            CHECK(chain_outputs["d"].data != buffer);
+        }
+    }
+
+    Scheduler::shared().setThreadBudget(0);
+    Scheduler::shared().plan(1);
+}
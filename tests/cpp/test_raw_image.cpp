@@ -0,0 +1,105 @@
+#include "test_runner.hpp"
+#include "../../src/cpp/runtime/hpp/raw_image_file.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // header of a valid packed image, for cases to break one field of
+    RawImageHeader validHeader(uint32_t width, uint32_t height, int type) {
+        RawImageHeader header{};
+        std::memcpy(header.magic, "SVRAWIMG", sizeof(header.magic));
+        header.version = 1;
+        header.data_offset = 4096;
+        header.width = width;
+        header.height = height;
+        header.type = static_cast<uint32_t>(type);
+        header.row_stride = uint64_t(width) * CV_ELEM_SIZE(type);
+        header.data_size = header.row_stride * height;
+        return header;
+    }
+
+    // header followed by `file_size` bytes in all
+    void writeRaw(const std::string& path, const RawImageHeader& header, uint64_t file_size) {
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fs::resize_file(path, file_size);
+    }
+}
+
+TEST_CASE(raw_image_round_trip) {
+    std::string directory = TestRunner::scratchDirectory("raw");
+    for (int type : {CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC3}) {
+        cv::Mat image;
+        TestRunner::sampleImage(cv::Size(131, 77), CV_MAKETYPE(CV_8U, CV_MAT_CN(type))).convertTo(image, type);
+        std::string path = (fs::path(directory) / ("image" + std::to_string(type) + ".svraw")).string();
+
+        CHECK(RawImageFile::write(path, image));
+        cv::Mat mapped = RawImageFile::map(path);
+        CHECK_SAME(mapped, image);
+
+        // copy-on-write: writing into the mapped mat leaves the file as it was
+        mapped.setTo(cv::Scalar::all(0));
+        CHECK_SAME(RawImageFile::map(path), image);
+
+        // rewriting the path while it is mapped replaces the file, not the mapped pages
+        cv::Mat input = RawImageFile::map(path);
+        CHECK(RawImageFile::write(path, cv::Mat(image * 0.5)));
+        CHECK_SAME(input, image);
+        CHECK_SAME(RawImageFile::map(path), cv::Mat(image * 0.5));
+    }
+}
+
+TEST_CASE(raw_image_rejects_malformed_headers) {
+    std::string path = (fs::path(TestRunner::scratchDirectory("raw")) / "bad.svraw").string();
+    const RawImageHeader good = validHeader(64, 32, CV_8UC3);
+    const uint64_t good_size = good.data_offset + good.data_size;
+
+    // the reference file maps
+    writeRaw(path, good, good_size);
+    CHECK(!RawImageFile::map(path).empty());
+
+    // truncated pixels, a header cut short, no file
+    writeRaw(path, good, good_size - 1);
+    CHECK(RawImageFile::map(path).empty());
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write("SVRAWIMG", 8);
+    CHECK(RawImageFile::map(path).empty());
+    fs::remove(path);
+    CHECK(RawImageFile::map(path).empty());
+
+    // one field broken at a time
+    auto rejects = [&path, good_size](RawImageHeader header) {
+        writeRaw(path, header, good_size);
+        return RawImageFile::map(path).empty();
+    };
+    RawImageHeader header = good;
+    header.magic[0] = 'X';
+    CHECK(rejects(header));
+    header = good;
+    header.version = 2;
+    CHECK(rejects(header));
+    header = good;
+    header.type = 7 << CV_CN_SHIFT | 7;
+    CHECK(rejects(header));
+    header = good;
+    header.row_stride += 1;
+    header.data_size = header.row_stride * header.height;
+    CHECK(rejects(header));
+    header = good;
+    header.data_size -= 1;
+    CHECK(rejects(header));
+
+    // a stride whose product with the height wraps to the data size
+    header = good;
+    header.height = 2;
+    header.row_stride = uint64_t(1) << 63;
+    header.data_size = 0;
+    CHECK(rejects(header));
+
+    // sides beyond an int, with sizes consistent in 64 bits
+    header = validHeader(0x80000000u, 1, CV_8UC1);
+    CHECK(rejects(header));
+    header = validHeader(1, 0x80000000u, CV_8UC1);
+    CHECK(rejects(header));
+}
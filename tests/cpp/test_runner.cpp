@@ -0,0 +1,112 @@
+#include "test_runner.hpp"
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct Failure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // name -> case, filled by the static initialisers of TEST_CASE
+    std::map<std::string, void (*)()>& registry() {
+        static std::map<std::string, void (*)()> cases;
+        return cases;
+    }
+
+    std::string running;
+
+    // run one case, reporting how it ended
+    bool runCase(const std::string& name, void (*test)()) {
+        running = name;
+        try {
+            test();
+        } catch (const Failure& failure) {
+            std::cerr << "FAIL " << name << ": " << failure.what() << std::endl;
+            return false;
+        } catch (const std::exception& e) {
+            std::cerr << "FAIL " << name << ": unexpected exception: " << e.what() << std::endl;
+            return false;
+        }
+        std::cout << "ok   " << name << std::endl;
+        return true;
+    }
+}
+
+bool TestRunner::add(const char* name, void (*test)()) {
+    registry()[name] = test;
+    return true;
+}
+
+void TestRunner::fail(const char* file, int line, const std::string& message) {
+    throw Failure(std::string(file) + ":" + std::to_string(line) + ": " + message);
+}
+
+cv::Mat TestRunner::sampleImage(cv::Size size, int type, uint64_t seed) {
+    cv::Mat image(size, type);
+    cv::RNG rng(seed);
+    for (int y = 0; y < size.height; ++y) {
+        uchar* row = image.ptr<uchar>(y);
+        for (int x = 0; x < size.width * image.channels(); ++x) {
+            int channel = x % image.channels();
+            double gradient = 255.0 * (x / image.channels() + 2 * y + 37 * channel) / (size.width + 2 * size.height);
+            row[x] = cv::saturate_cast<uchar>(std::fmod(gradient, 256.0) + rng.gaussian(12.0));
+        }
+    }
+    cv::rectangle(image, cv::Rect(size.width / 5, size.height / 4, size.width / 3, size.height / 3), cv::Scalar::all(250), cv::FILLED);
+    cv::circle(image, cv::Point(size.width * 2 / 3, size.height / 2), size.height / 5, cv::Scalar::all(5), cv::FILLED);
+    return image;
+}
+
+PipelineConfig TestRunner::parse(const std::string& json_text) {
+    return PipelineReader::parsePipeline(nlohmann::json::parse(json_text));
+}
+
+cv::Mat TestRunner::run(const PipelineConfig& config, const cv::Mat& image, bool fuse_pointwise) {
+    CompiledPipeline pipeline = PipelineCompiler::compile(config, fuse_pointwise);
+    cv::Mat result = image.clone();
+    for (const auto& step : pipeline.steps) {
+        result = step.operation->execute(result, step.roi, step.parameters);
+    }
+    return result;
+}
+
+bool TestRunner::same(const cv::Mat& a, const cv::Mat& b) {
+    return a.size() == b.size() && a.type() == b.type() && maxDifference(a, b) == 0.0;
+}
+
+double TestRunner::maxDifference(const cv::Mat& a, const cv::Mat& b) {
+    if (a.empty() && b.empty()) {
+        return 0.0;
+    }
+    return cv::norm(a, b, cv::NORM_INF);
+}
+
+std::string TestRunner::scratchDirectory(const std::string& name) {
+    fs::path directory = fs::temp_directory_path() / ("sea_vision_tests-" + running + "-" + name);
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    return directory.string();
+}
+
+int main(int argc, char** argv) {
+    int failed = 0;
+    if (argc < 2) {
+        for (const auto& [name, test] : registry()) {
+            failed += runCase(name, test) ? 0 : 1;
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        auto it = registry().find(argv[i]);
+        if (it == registry().end()) {
+            std::cerr << "FAIL unknown test case: " << argv[i] << std::endl;
+            ++failed;
+            continue;
+        }
+        failed += runCase(it->first, it->second) ? 0 : 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
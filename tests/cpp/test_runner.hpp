@@ -0,0 +1,70 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include "../../src/cpp/bindings/hpp/pipeline_reader.hpp"
+#include "../../src/cpp/pipeline/hpp/pipeline_compiler.hpp"
+
+// minimal test registry for sea_vision_tests: every TEST_CASE registers itself by name, and the
+// runner runs the cases named on the command line (one per ctest entry) or all of them
+namespace TestRunner {
+    // register a case; returns true so registration can initialise a static
+    bool add(const char* name, void (*test)());
+
+    // stop the running case with a message pointing at the failed check
+    [[noreturn]] void fail(const char* file, int line, const std::string& message);
+
+    // deterministic 8-bit test image: smooth gradients with noise and a few hard edges, so
+    // filters, borders and tables all have something to change
+    cv::Mat sampleImage(cv::Size size, int type = CV_8UC3, uint64_t seed = 1);
+
+    // pipeline parsed from json text
+    PipelineConfig parse(const std::string& json_text);
+
+    // reference run: compile the pipeline and apply step after step with Operation::execute,
+    // without the executor's in-place paths, tiles, regions or caches
+    cv::Mat run(const PipelineConfig& config, const cv::Mat& image, bool fuse_pointwise = true);
+
+    // true if both images have the same size, type and pixels
+    bool same(const cv::Mat& a, const cv::Mat& b);
+
+    // largest absolute difference between two images of the same size and type
+    double maxDifference(const cv::Mat& a, const cv::Mat& b);
+
+    // empty directory for the running case under the system temp directory
+    std::string scratchDirectory(const std::string& name);
+}
+
+#define TEST_CASE(name)                                                        \
+    static void name();                                                        \
+    static const bool name##_registered = TestRunner::add(#name, name);       \
+    static void name()
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if (!(condition)) {                                                    \
+            TestRunner::fail(__FILE__, __LINE__, "CHECK(" #condition ")");     \
+        }                                                                      \
+    } while (0)
+
+// both images equal in size, type and every pixel
+#define CHECK_SAME(a, b)                                                       \
+    do {                                                                       \
+        if (!TestRunner::same((a), (b))) {                                     \
+            TestRunner::fail(__FILE__, __LINE__, "CHECK_SAME(" #a ", " #b ")");\
+        }                                                                      \
+    } while (0)
+
+// the statement throws std::exception
+#define CHECK_THROWS(statement)                                                \
+    do {                                                                       \
+        bool thrown = false;                                                   \
+        try {                                                                  \
+            statement;                                                         \
+        } catch (const std::exception&) {                                      \
+            thrown = true;                                                     \
+        }                                                                      \
+        if (!thrown) {                                                         \
+            TestRunner::fail(__FILE__, __LINE__, "CHECK_THROWS(" #statement ")"); \
+        }                                                                      \
+    } while (0)